@@ -0,0 +1,418 @@
+/**
+ * Bit vector
+ *
+ * Vector of bools stored one bit each in 64 bit words. Bulk operations work a
+ * word at a time and counting uses popcount. Bits past size() in the last
+ * word are always zero, so whole words can be combined and counted without
+ * masking.
+ */
+#pragma once
+
+#include "../vector/Vector.cpp"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace ds {
+
+	class bit_vector {
+	public:
+		typedef bool value_type;
+		typedef size_t size_type;
+		typedef ptrdiff_t difference_type;
+		typedef bool const_reference;
+		typedef uint64_t word_type;
+
+		static constexpr size_type word_bits = 64;
+
+		/**
+		 * proxy for one bit
+		 */
+		class reference {
+		public:
+			operator bool() const { return (*m_word >> m_bit) & 1; }
+
+			reference& operator=(bool value) {
+				*m_word = (*m_word & ~(word_type(1) << m_bit)) | (word_type(value) << m_bit);
+				return *this;
+			}
+
+			reference& operator=(const reference& other) { return *this = bool(other); }
+
+			void flip() { *m_word ^= word_type(1) << m_bit; }
+
+			bool operator~() const { return !bool(*this); }
+
+			/**
+			 * swaps the referenced bits, so that algorithms such as std::sort work
+			 */
+			friend void swap(reference lhs, reference rhs) {
+				const bool value = lhs;
+				lhs = bool(rhs);
+				rhs = value;
+			}
+
+		private:
+			friend class bit_vector;
+
+			reference(word_type* word, unsigned bit) : m_word(word), m_bit(bit) {}
+
+			word_type* m_word;
+			unsigned m_bit;
+		};
+
+		template <bool is_const>
+		class basic_iterator {
+			typedef typename std::conditional<is_const, const bit_vector*, bit_vector*>::type vector_pointer;
+
+		public:
+			typedef std::random_access_iterator_tag iterator_category;
+			typedef bool value_type;
+			typedef ptrdiff_t difference_type;
+			typedef typename std::conditional<is_const, bool, typename bit_vector::reference>::type reference;
+			typedef void pointer;
+
+			basic_iterator() : m_vector(), m_index() {}
+
+			basic_iterator(vector_pointer vector, size_type index) : m_vector(vector), m_index(index) {}
+
+			template <bool other_const, class = typename std::enable_if<is_const && !other_const>::type>
+			basic_iterator(const basic_iterator<other_const>& other) : m_vector(other.m_vector), m_index(other.m_index) {}
+
+			reference operator*() const { return (*m_vector)[m_index]; }
+
+			reference operator[](difference_type n) const { return (*m_vector)[m_index + n]; }
+
+			basic_iterator& operator++() {
+				++m_index;
+				return *this;
+			}
+
+			basic_iterator operator++(int) { return basic_iterator(m_vector, m_index++); }
+
+			basic_iterator& operator--() {
+				--m_index;
+				return *this;
+			}
+
+			basic_iterator operator--(int) { return basic_iterator(m_vector, m_index--); }
+
+			basic_iterator& operator+=(difference_type n) {
+				m_index += n;
+				return *this;
+			}
+
+			basic_iterator& operator-=(difference_type n) {
+				m_index -= n;
+				return *this;
+			}
+
+			basic_iterator operator+(difference_type n) const { return basic_iterator(m_vector, m_index + n); }
+
+			friend basic_iterator operator+(difference_type n, const basic_iterator& it) { return it + n; }
+
+			basic_iterator operator-(difference_type n) const { return basic_iterator(m_vector, m_index - n); }
+
+			difference_type operator-(const basic_iterator& rhs) const { return m_index - rhs.m_index; }
+
+			bool operator==(const basic_iterator& rhs) const { return m_index == rhs.m_index; }
+
+			bool operator!=(const basic_iterator& rhs) const { return m_index != rhs.m_index; }
+
+			bool operator<(const basic_iterator& rhs) const { return m_index < rhs.m_index; }
+
+			bool operator>(const basic_iterator& rhs) const { return m_index > rhs.m_index; }
+
+			bool operator<=(const basic_iterator& rhs) const { return m_index <= rhs.m_index; }
+
+			bool operator>=(const basic_iterator& rhs) const { return m_index >= rhs.m_index; }
+
+		private:
+			friend class bit_vector;
+
+			vector_pointer m_vector;
+			size_type m_index;
+		};
+
+		typedef basic_iterator<false> iterator;
+		typedef basic_iterator<true> const_iterator;
+
+		// Constructors
+
+		bit_vector() : m_size(0) {}
+
+		/**
+		 * n bits, all equal to value
+		 */
+		explicit bit_vector(size_type n, bool value = false) : m_words(words_for(n), value ? ~word_type(0) : 0), m_size(n) {
+			clear_unused();
+		}
+
+		template <class InputIterator, class = typename std::iterator_traits<InputIterator>::iterator_category>
+		bit_vector(InputIterator first, InputIterator last) : bit_vector() {
+			for (; first != last; ++first)
+				push_back(bool(*first));
+		}
+
+		bit_vector(std::initializer_list<bool> il) : bit_vector(il.begin(), il.end()) {}
+
+		// Iterators
+
+		iterator begin() { return iterator(this, 0); }
+
+		const_iterator begin() const { return const_iterator(this, 0); }
+
+		const_iterator cbegin() const { return begin(); }
+
+		iterator end() { return iterator(this, m_size); }
+
+		const_iterator end() const { return const_iterator(this, m_size); }
+
+		const_iterator cend() const { return end(); }
+
+		// Capacity
+
+		size_type size() const { return m_size; }
+
+		bool empty() const { return m_size == 0; }
+
+		void reserve(size_type n) { m_words.reserve(words_for(n)); }
+
+		void shrink_to_fit() { m_words.shrink_to_fit(); }
+
+		void resize(size_type n, bool value = false) {
+			if (n > m_size && value) {
+				// fill the rest of the last word, then whole words
+				if (m_size % word_bits) m_words.back() |= ~word_type(0) << (m_size % word_bits);
+				m_words.resize(words_for(n), ~word_type(0));
+			} else {
+				m_words.resize(words_for(n), 0);
+			}
+			m_size = n;
+			clear_unused();
+		}
+
+		// Element access
+
+		bool test(size_type n) const { return (m_words[n / word_bits] >> (n % word_bits)) & 1; }
+
+		reference operator[](size_type n) { return reference(&m_words[n / word_bits], n % word_bits); }
+
+		bool operator[](size_type n) const { return test(n); }
+
+		reference at(size_type n) {
+			if (n >= m_size) throw std::out_of_range("ds::bit_vector::at");
+			return (*this)[n];
+		}
+
+		bool at(size_type n) const {
+			if (n >= m_size) throw std::out_of_range("ds::bit_vector::at");
+			return test(n);
+		}
+
+		reference front() { return (*this)[0]; }
+
+		bool front() const { return test(0); }
+
+		reference back() { return (*this)[m_size - 1]; }
+
+		bool back() const { return test(m_size - 1); }
+
+		/**
+		 * the underlying words, bit n is bit n % 64 of word n / 64
+		 */
+		const word_type* data() const { return m_words.data(); }
+
+		size_type word_count() const { return m_words.size(); }
+
+		// Bit operations
+
+		bit_vector& set(size_type n, bool value = true) {
+			(*this)[n] = value;
+			return *this;
+		}
+
+		bit_vector& reset(size_type n) { return set(n, false); }
+
+		bit_vector& flip(size_type n) {
+			m_words[n / word_bits] ^= word_type(1) << (n % word_bits);
+			return *this;
+		}
+
+		bit_vector& set() {
+			std::fill(m_words.begin(), m_words.end(), ~word_type(0));
+			clear_unused();
+			return *this;
+		}
+
+		bit_vector& reset() {
+			std::fill(m_words.begin(), m_words.end(), word_type(0));
+			return *this;
+		}
+
+		bit_vector& flip() {
+			for (word_type& word : m_words)
+				word = ~word;
+			clear_unused();
+			return *this;
+		}
+
+		/**
+		 * the number of set bits
+		 */
+		size_type count() const {
+			size_type count = 0;
+			for (word_type word : m_words)
+				count += __builtin_popcountll(word);
+			return count;
+		}
+
+		bool any() const {
+			return std::any_of(m_words.begin(), m_words.end(), [](word_type word) { return word != 0; });
+		}
+
+		bool none() const { return !any(); }
+
+		bool all() const { return count() == m_size; }
+
+		/**
+		 * @brief the bitwise operations need vectors of equal size
+		 * @throws std::invalid_argument if the sizes differ
+		 */
+		bit_vector& operator&=(const bit_vector& other) {
+			check_size(other);
+			for (size_type i = 0; i < m_words.size(); ++i)
+				m_words[i] &= other.m_words[i];
+			return *this;
+		}
+
+		bit_vector& operator|=(const bit_vector& other) {
+			check_size(other);
+			for (size_type i = 0; i < m_words.size(); ++i)
+				m_words[i] |= other.m_words[i];
+			return *this;
+		}
+
+		bit_vector& operator^=(const bit_vector& other) {
+			check_size(other);
+			for (size_type i = 0; i < m_words.size(); ++i)
+				m_words[i] ^= other.m_words[i];
+			return *this;
+		}
+
+		/**
+		 * clears every bit that is set in other
+		 */
+		bit_vector& operator-=(const bit_vector& other) {
+			check_size(other);
+			for (size_type i = 0; i < m_words.size(); ++i)
+				m_words[i] &= ~other.m_words[i];
+			return *this;
+		}
+
+		bit_vector operator~() const { return bit_vector(*this).flip(); }
+
+		// Set bit search
+
+		/**
+		 * the position of the first set bit, or size() if there is none
+		 */
+		size_type find_first() const { return find_from(0); }
+
+		/**
+		 * the position of the first set bit after n, or size() if there is none
+		 */
+		size_type find_next(size_type n) const { return find_from(n + 1); }
+
+		/**
+		 * calls f(position) for every set bit in increasing order, skipping
+		 * zero words and visiting each set bit with one count trailing zeros
+		 */
+		template <class Function>
+		void for_each_set(Function f) const {
+			for (size_type i = 0; i < m_words.size(); ++i)
+				for (word_type word = m_words[i]; word; word &= word - 1)
+					f(i*word_bits + __builtin_ctzll(word));
+		}
+
+		// Modifiers
+
+		void push_back(bool value) {
+			if (m_size % word_bits == 0) m_words.push_back(0);
+			m_words.back() |= word_type(value) << (m_size % word_bits);
+			++m_size;
+		}
+
+		void pop_back() {
+			--m_size;
+			if (m_size % word_bits == 0)
+				m_words.pop_back();
+			else
+				m_words.back() &= ~(word_type(1) << (m_size % word_bits));
+		}
+
+		void clear() {
+			m_words.clear();
+			m_size = 0;
+		}
+
+		void swap(bit_vector& other) {
+			m_words.swap(other.m_words);
+			std::swap(m_size, other.m_size);
+		}
+
+		friend bool operator==(const bit_vector& lhs, const bit_vector& rhs) {
+			return lhs.m_size == rhs.m_size && std::equal(lhs.m_words.begin(), lhs.m_words.end(), rhs.m_words.begin());
+		}
+
+		friend bool operator!=(const bit_vector& lhs, const bit_vector& rhs) { return !(lhs == rhs); }
+
+	private:
+		Vector<word_type> m_words;
+		size_type m_size;
+
+		static size_type words_for(size_type n) { return (n + word_bits - 1) / word_bits; }
+
+		/**
+		 * zeroes the bits of the last word past size()
+		 */
+		void clear_unused() {
+			if (m_size % word_bits) m_words.back() &= ~(~word_type(0) << (m_size % word_bits));
+		}
+
+		void check_size(const bit_vector& other) const {
+			if (m_size != other.m_size) throw std::invalid_argument("ds::bit_vector: sizes differ");
+		}
+
+		size_type find_from(size_type n) const {
+			if (n >= m_size) return m_size;
+			size_type i = n / word_bits;
+			word_type word = m_words[i] & (~word_type(0) << (n % word_bits));
+			while (word == 0) {
+				if (++i == m_words.size()) return m_size;
+				word = m_words[i];
+			}
+			return i*word_bits + __builtin_ctzll(word);
+		}
+	};
+
+	inline bit_vector operator&(bit_vector lhs, const bit_vector& rhs) { return lhs &= rhs; }
+
+	inline bit_vector operator|(bit_vector lhs, const bit_vector& rhs) { return lhs |= rhs; }
+
+	inline bit_vector operator^(bit_vector lhs, const bit_vector& rhs) { return lhs ^= rhs; }
+
+	inline bit_vector operator-(bit_vector lhs, const bit_vector& rhs) { return lhs -= rhs; }
+}
+
+namespace std {
+	inline void swap(ds::bit_vector& lhs, ds::bit_vector& rhs) {
+		lhs.swap(rhs);
+	}
+}
@@ -0,0 +1,210 @@
+/**
+ * Rank and select
+ *
+ * Read only index over a bit_vector answering
+ *
+ * rank1(i)    the number of set bits before position i, in O(1)
+ * select1(k)  the position of the k-th set bit, counting from 0
+ *
+ * and their rank0 and select0 counterparts for clear bits.
+ *
+ * The rank directory follows rank9: for every 512 bit block it keeps two
+ * words, the number of set bits before the block and seven 9 bit counts of
+ * the set bits before each of the block's other words, so a rank is two
+ * loads and one popcount. That costs 25% on top of the bits.
+ *
+ * Select keeps the block of every 512th set (and clear) bit. A query
+ * binary searches the blocks between two samples, picks the word from the
+ * block's 9 bit counts and finds the bit in it with pdep when BMI2 is
+ * available, or a byte at a time otherwise.
+ *
+ * The index refers to the bit_vector it was built from, which must outlive it
+ * and not change while it is used; call build() again after changing it.
+ */
+#pragma once
+
+#include "bit_vector.cpp"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <algorithm>
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+namespace ds {
+
+	class rank_select {
+	public:
+		typedef size_t size_type;
+		typedef bit_vector::word_type word_type;
+
+		static constexpr size_type block_bits = 512;
+		static constexpr size_type block_words = block_bits / bit_vector::word_bits;
+		// one select sample per this many set or clear bits
+		static constexpr size_type sample_rate = 512;
+
+		rank_select() : m_bits(), m_ones(0) {}
+
+		explicit rank_select(const bit_vector& bits) { build(bits); }
+
+		/**
+		 * indexes bits, replacing the previous index
+		 */
+		void build(const bit_vector& bits) {
+			m_bits = &bits;
+			const size_type words = bits.word_count();
+			const size_type blocks = (words + block_words - 1) / block_words;
+			const word_type* data = bits.data();
+
+			m_counts.clear();
+			m_counts.reserve(2*(blocks + 1));
+			size_type ones = 0;
+			for (size_type b = 0; b < blocks; ++b) {
+				m_counts.push_back(ones);
+				word_type relative = 0;
+				size_type in_block = 0;
+				for (size_type w = 0; w < block_words; ++w) {
+					if (w > 0) relative |= word_type(in_block) << (9*(w - 1));
+					if (b*block_words + w < words) in_block += __builtin_popcountll(data[b*block_words + w]);
+				}
+				m_counts.push_back(relative);
+				ones += in_block;
+			}
+			// a last entry so that rank1(size()) needs no special case
+			m_counts.push_back(ones);
+			m_counts.push_back(0);
+			m_ones = ones;
+
+			m_select1.clear();
+			m_select0.clear();
+			for (size_type b = 0; b < blocks; ++b) {
+				const size_type end = std::min((b + 1)*block_bits, bits.size());
+				while (m_select1.size()*sample_rate < ones_before(b + 1))
+					m_select1.push_back(b);
+				while (m_select0.size()*sample_rate < end - ones_before(b + 1))
+					m_select0.push_back(b);
+			}
+		}
+
+		const bit_vector& bits() const { return *m_bits; }
+
+		size_type size() const { return m_bits ? m_bits->size() : 0; }
+
+		/**
+		 * the number of set bits
+		 */
+		size_type ones() const { return m_ones; }
+
+		size_type zeros() const { return size() - m_ones; }
+
+		/**
+		 * the number of set bits in [0, i), for i <= size()
+		 */
+		size_type rank1(size_type i) const {
+			const size_type b = i / block_bits;
+			size_type rank = m_counts[2*b] + relative(b, (i / bit_vector::word_bits) % block_words);
+			if (i % bit_vector::word_bits)
+				rank += __builtin_popcountll(m_bits->data()[i / bit_vector::word_bits] &
+				                             ~(~word_type(0) << (i % bit_vector::word_bits)));
+			return rank;
+		}
+
+		/**
+		 * the number of clear bits in [0, i), for i <= size()
+		 */
+		size_type rank0(size_type i) const { return i - rank1(i); }
+
+		/**
+		 * the position of set bit k, counting from 0, or size() if k >= ones()
+		 */
+		size_type select1(size_type k) const {
+			if (k >= m_ones) return size();
+			const size_type b = find_block<true>(k, m_select1);
+			size_type rest = k - ones_before(b);
+			size_type w = 1;
+			while (w < block_words && relative(b, w) <= rest)
+				++w;
+			rest -= relative(b, w - 1);
+			const size_type word = b*block_words + w - 1;
+			return word*bit_vector::word_bits + select_in_word(m_bits->data()[word], rest);
+		}
+
+		/**
+		 * the position of clear bit k, counting from 0, or size() if k >= zeros()
+		 */
+		size_type select0(size_type k) const {
+			if (k >= zeros()) return size();
+			const size_type b = find_block<false>(k, m_select0);
+			size_type rest = k - zeros_before(b);
+			size_type w = 1;
+			while (w < block_words && w*bit_vector::word_bits - relative(b, w) <= rest)
+				++w;
+			rest -= (w - 1)*bit_vector::word_bits - relative(b, w - 1);
+			const size_type word = b*block_words + w - 1;
+			return word*bit_vector::word_bits + select_in_word(~m_bits->data()[word], rest);
+		}
+
+	private:
+		const bit_vector* m_bits;
+		// per block: set bits before it, then the packed 9 bit counts
+		Vector<word_type> m_counts;
+		// the block holding every sample_rate-th set and clear bit
+		Vector<size_type> m_select1;
+		Vector<size_type> m_select0;
+		size_type m_ones;
+
+		size_type ones_before(size_type b) const { return m_counts[2*b]; }
+
+		size_type zeros_before(size_type b) const { return b*block_bits - m_counts[2*b]; }
+
+		/**
+		 * set bits in the words of block b before word w
+		 */
+		size_type relative(size_type b, size_type w) const {
+			// w = 0 shifts by 63, past the seven counts, and yields 0 without a branch
+			const size_type t = w - 1;
+			return (m_counts[2*b + 1] >> (9*(t + ((t >> 60) & 8)))) & 0x1ff;
+		}
+
+		/**
+		 * the last block b whose count of set (or clear) bits before it is at
+		 * most k, searched between the samples around k
+		 */
+		template <bool one>
+		size_type find_block(size_type k, const Vector<size_type>& samples) const {
+			size_type low = samples[k / sample_rate];
+			size_type high = k / sample_rate + 1 < samples.size() ? samples[k / sample_rate + 1] : m_counts.size()/2 - 2;
+			while (low < high) {
+				const size_type middle = low + (high - low + 1) / 2;
+				if ((one ? ones_before(middle) : zeros_before(middle)) <= k)
+					low = middle;
+				else
+					high = middle - 1;
+			}
+			return low;
+		}
+
+		/**
+		 * the position of set bit k of word
+		 */
+		static unsigned select_in_word(word_type word, size_type k) {
+#if defined(__BMI2__)
+			return __builtin_ctzll(_pdep_u64(word_type(1) << k, word));
+#else
+			unsigned position = 0;
+			for (;;) {
+				const unsigned in_byte = __builtin_popcountll(word & 0xff);
+				if (k < in_byte) break;
+				k -= in_byte;
+				word >>= 8;
+				position += 8;
+			}
+			for (; k > 0; --k)
+				word &= word - 1;
+			return position + __builtin_ctzll(word);
+#endif
+		}
+	};
+}
@@ -0,0 +1,29 @@
+/**
+ * Node shared by the lock-free containers. It has the layout of the
+ * Forward_list node, a next pointer followed by aligned storage for the value,
+ * with the next pointer made atomic.
+ */
+#pragma once
+
+#include <atomic>
+#include <type_traits>
+
+namespace ds {
+
+	template <typename T>
+	struct atomic_node {
+
+		atomic_node() : next(nullptr), value() {}
+
+		T* val_ptr() {
+			return reinterpret_cast<T*>(&value);
+		}
+
+		const T* val_ptr() const {
+			return reinterpret_cast<const T*>(&value);
+		}
+
+		std::atomic<atomic_node*> next;
+		typename std::aligned_storage<sizeof(T), alignof(T)>::type value;
+	};
+}
@@ -0,0 +1,163 @@
+/**
+ * Epoch based reclamation
+ *
+ * A drop in alternative to ds::hazard_pointers. Instead of publishing every
+ * pointer, a guard pins the calling thread to the global epoch for its whole
+ * lifetime, which makes protect a plain load. The epoch advances once every
+ * pinned thread has seen it, and a pointer retired in epoch e is reclaimed when
+ * the epoch reaches e + 2. A thread that stays pinned holds back reclamation
+ * for everyone.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <algorithm>
+#include <atomic>
+#include <tuple>
+#include <vector>
+
+namespace ds {
+
+	class epoch_reclamation {
+		struct record;
+
+	public:
+		/**
+		 * Pins the calling thread for its lifetime, guards may nest. A guard
+		 * must be used by the thread that created it.
+		 */
+		class guard {
+		public:
+			guard() : m_record(&local_record()) {
+				if (m_record->nesting++ == 0) {
+					m_record->state.store(global_epoch().load() << 1 | 1, std::memory_order_relaxed);
+					std::atomic_thread_fence(std::memory_order_seq_cst);
+				}
+			}
+
+			guard(const guard&) = delete;
+
+			guard& operator=(const guard&) = delete;
+
+			~guard() {
+				if (--m_record->nesting == 0) m_record->state.store(0, std::memory_order_release);
+			}
+
+			template <class P>
+			P* protect(const std::atomic<P*>& src) { return src.load(std::memory_order_acquire); }
+
+			/**
+			 * the thread stays pinned until the guard is destroyed
+			 */
+			void reset() {}
+
+		private:
+			record* m_record;
+		};
+
+		/**
+		 * hands ptr to the reclaimer, reclaim(ptr) is called two epochs later
+		 */
+		static void retire(void* ptr, void (*reclaim)(void*)) {
+			record& rec = local_record();
+			rec.retired.emplace_back(ptr, reclaim, global_epoch().load());
+			if (rec.retired.size() >= scan_threshold) scan(rec);
+		}
+
+		template <class T>
+		static void retire(T* ptr) {
+			retire(ptr, [](void* p) { delete static_cast<T*>(p); });
+		}
+
+		/**
+		 * tries to advance the epoch and reclaims what the calling thread may
+		 */
+		static void collect() { scan(local_record()); }
+
+	private:
+		typedef std::tuple<void*, void (*)(void*), size_t> retired_ptr;
+
+		static constexpr size_t scan_threshold = 64;
+
+		struct record {
+			// epoch << 1 | 1 while pinned, 0 otherwise
+			std::atomic<size_t> state;
+			std::atomic<bool> active;
+			record* next;
+			size_t nesting;
+			std::vector<retired_ptr> retired;
+
+			record() : state(0), active(true), next(), nesting() {}
+		};
+
+		struct thread_owner {
+			record* rec;
+
+			thread_owner() : rec(acquire_record()) {}
+
+			~thread_owner() {
+				scan(*rec);
+				rec->active.store(false, std::memory_order_release);
+			}
+		};
+
+		static std::atomic<size_t>& global_epoch() {
+			static std::atomic<size_t> epoch(0);
+			return epoch;
+		}
+
+		static std::atomic<record*>& records() {
+			static std::atomic<record*> head(nullptr);
+			return head;
+		}
+
+		static record& local_record() {
+			static thread_local thread_owner owner;
+			return *owner.rec;
+		}
+
+		/**
+		 * reuses the record of an exited thread, its retired pointers are
+		 * adopted along with it
+		 */
+		static record* acquire_record() {
+			for (record* rec = records().load(std::memory_order_acquire); rec; rec = rec->next) {
+				bool active = false;
+				if (!rec->active.load(std::memory_order_relaxed)
+				    && rec->active.compare_exchange_strong(active, true, std::memory_order_acquire))
+					return rec;
+			}
+
+			record* rec = new record;
+			record* head = records().load(std::memory_order_relaxed);
+			do {
+				rec->next = head;
+			} while (!records().compare_exchange_weak(head, rec, std::memory_order_release, std::memory_order_relaxed));
+			return rec;
+		}
+
+		/**
+		 * advances the global epoch if every pinned thread has seen it
+		 */
+		static size_t try_advance() {
+			size_t epoch = global_epoch().load();
+			for (record* rec = records().load(std::memory_order_acquire); rec; rec = rec->next) {
+				const size_t state = rec->state.load();
+				if ((state & 1) && state >> 1 != epoch) return epoch;
+			}
+			global_epoch().compare_exchange_strong(epoch, epoch + 1);
+			return global_epoch().load();
+		}
+
+		static void scan(record& rec) {
+			const size_t epoch = try_advance();
+
+			std::vector<retired_ptr> retired;
+			retired.swap(rec.retired);
+			for (const retired_ptr& ptr : retired) {
+				if (std::get<2>(ptr) + 2 > epoch) rec.retired.push_back(ptr);
+				else std::get<1>(ptr)(std::get<0>(ptr));
+			}
+		}
+	};
+}
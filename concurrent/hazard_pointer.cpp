@@ -0,0 +1,180 @@
+/**
+ * Hazard pointers
+ *
+ * Safe memory reclamation for lock-free containers. A thread publishes the
+ * pointer it is about to dereference in one of its hazard slots, and retired
+ * pointers are only reclaimed once no slot holds them. Every thread owns a
+ * record with its slots and its retired pointers; records are reused when
+ * threads exit and are never freed.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace ds {
+
+	class hazard_pointers {
+		struct record;
+
+	public:
+		static constexpr size_t slots_per_thread = 4;
+
+		/**
+		 * Owns one hazard slot of the calling thread for its lifetime. A guard
+		 * must be used by the thread that created it.
+		 */
+		class guard {
+		public:
+			guard() : m_record(&local_record()), m_slot(m_record->acquire_slot()) {}
+
+			guard(const guard&) = delete;
+
+			guard& operator=(const guard&) = delete;
+
+			~guard() {
+				reset();
+				m_record->used[m_slot] = false;
+			}
+
+			/**
+			 * returns the current value of src once it is published in the slot,
+			 * the pointee stays valid until the guard is reset
+			 */
+			template <class P>
+			P* protect(const std::atomic<P*>& src) {
+				P* ptr = src.load(std::memory_order_relaxed);
+				for (;;) {
+					m_record->hazards[m_slot].store(ptr);
+					P* current = src.load();
+					if (current == ptr) return ptr;
+					ptr = current;
+				}
+			}
+
+			void reset() { m_record->hazards[m_slot].store(nullptr, std::memory_order_release); }
+
+		private:
+			record* m_record;
+			size_t m_slot;
+		};
+
+		/**
+		 * hands ptr to the reclaimer, reclaim(ptr) is called once no hazard
+		 * slot points to it
+		 */
+		static void retire(void* ptr, void (*reclaim)(void*)) {
+			record& rec = local_record();
+			rec.retired.emplace_back(ptr, reclaim);
+			if (rec.retired.size() >= scan_threshold()) scan(rec);
+		}
+
+		template <class T>
+		static void retire(T* ptr) {
+			retire(ptr, [](void* p) { delete static_cast<T*>(p); });
+		}
+
+		/**
+		 * reclaims every retired pointer of the calling thread that is not
+		 * protected
+		 */
+		static void collect() { scan(local_record()); }
+
+	private:
+		typedef std::pair<void*, void (*)(void*)> retired_ptr;
+
+		struct record {
+			std::atomic<const void*> hazards[slots_per_thread];
+			std::atomic<bool> active;
+			record* next;
+			bool used[slots_per_thread];
+			std::vector<retired_ptr> retired;
+
+			record() : active(true), next(), used() {
+				for (auto& hazard : hazards)
+					hazard.store(nullptr, std::memory_order_relaxed);
+			}
+
+			size_t acquire_slot() {
+				for (size_t slot = 0; slot < slots_per_thread; ++slot) {
+					if (!used[slot]) {
+						used[slot] = true;
+						return slot;
+					}
+				}
+				throw std::length_error("ds::hazard_pointers: out of hazard slots");
+			}
+		};
+
+		struct thread_owner {
+			record* rec;
+
+			thread_owner() : rec(acquire_record()) {}
+
+			~thread_owner() {
+				scan(*rec);
+				rec->active.store(false, std::memory_order_release);
+			}
+		};
+
+		static std::atomic<record*>& records() {
+			static std::atomic<record*> head(nullptr);
+			return head;
+		}
+
+		static std::atomic<size_t>& record_count() {
+			static std::atomic<size_t> count(0);
+			return count;
+		}
+
+		static record& local_record() {
+			static thread_local thread_owner owner;
+			return *owner.rec;
+		}
+
+		static size_t scan_threshold() {
+			return std::max<size_t>(64, 2*slots_per_thread*record_count().load(std::memory_order_relaxed));
+		}
+
+		/**
+		 * reuses the record of an exited thread, its retired pointers are
+		 * adopted along with it
+		 */
+		static record* acquire_record() {
+			for (record* rec = records().load(std::memory_order_acquire); rec; rec = rec->next) {
+				bool active = false;
+				if (!rec->active.load(std::memory_order_relaxed)
+				    && rec->active.compare_exchange_strong(active, true, std::memory_order_acquire))
+					return rec;
+			}
+
+			record* rec = new record;
+			record* head = records().load(std::memory_order_relaxed);
+			do {
+				rec->next = head;
+			} while (!records().compare_exchange_weak(head, rec, std::memory_order_release, std::memory_order_relaxed));
+			record_count().fetch_add(1, std::memory_order_relaxed);
+			return rec;
+		}
+
+		static void scan(record& rec) {
+			std::vector<const void*> protected_ptrs;
+			for (record* other = records().load(std::memory_order_acquire); other; other = other->next) {
+				for (auto& hazard : other->hazards)
+					if (const void* ptr = hazard.load()) protected_ptrs.push_back(ptr);
+			}
+			std::sort(protected_ptrs.begin(), protected_ptrs.end());
+
+			std::vector<retired_ptr> retired;
+			retired.swap(rec.retired);
+			for (const retired_ptr& ptr : retired) {
+				if (std::binary_search(protected_ptrs.begin(), protected_ptrs.end(), ptr.first)) rec.retired.push_back(ptr);
+				else ptr.second(ptr.first);
+			}
+		}
+	};
+}
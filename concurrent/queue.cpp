@@ -0,0 +1,223 @@
+/**
+ * Lock-free queues
+ *
+ * ds::mpmc_queue is the Michael-Scott queue, any number of threads may push
+ * and pop. Popped nodes are reclaimed through the Reclaimer, hazard pointers
+ * by default.
+ *
+ * ds::mpsc_queue is Vyukov's intrusive queue with a stub node, any number of
+ * threads may push but only one thread may pop. Producers never touch a node
+ * after linking it, so nodes are freed directly by the consumer.
+ */
+#include "atomic_node.cpp"
+#include "epoch.cpp"
+#include "hazard_pointer.cpp"
+
+#include <stddef.h>
+#include <atomic>
+#include <utility>
+
+namespace ds {
+
+	template <typename T, class Reclaimer = hazard_pointers>
+	class mpmc_queue {
+		typedef atomic_node<T> node_type;
+
+	public:
+		typedef T value_type;
+		typedef size_t size_type;
+
+		mpmc_queue() {
+			node_type* dummy = new node_type;
+			m_head.store(dummy, std::memory_order_relaxed);
+			m_tail.store(dummy, std::memory_order_relaxed);
+		}
+
+		mpmc_queue(const mpmc_queue&) = delete;
+
+		mpmc_queue& operator=(const mpmc_queue&) = delete;
+
+		/**
+		 * must not run concurrently with any other member
+		 */
+		~mpmc_queue() {
+			node_type* node = m_head.load(std::memory_order_relaxed);
+			for (node_type* next; (next = node->next.load(std::memory_order_relaxed)); node = next) {
+				next->val_ptr()->~T();
+				delete node;
+			}
+			delete node;
+		}
+
+		void push(const T& value) { emplace(value); }
+
+		void push(T&& value) { emplace(std::move(value)); }
+
+		template <class... Args>
+		void emplace(Args&&... args) {
+			node_type* node = new node_type;
+			try {
+				::new (static_cast<void*>(node->val_ptr())) T(std::forward<Args>(args)...);
+			} catch (...) {
+				delete node;
+				throw;
+			}
+
+			typename Reclaimer::guard tail_guard;
+			for (;;) {
+				node_type* tail = tail_guard.protect(m_tail);
+				node_type* next = tail->next.load(std::memory_order_acquire);
+				if (next) {
+					m_tail.compare_exchange_weak(tail, next);
+					continue;
+				}
+				if (tail->next.compare_exchange_weak(next, node)) {
+					m_tail.compare_exchange_strong(tail, node);
+					return;
+				}
+			}
+		}
+
+		/**
+		 * Moves the front value into out. The value lives in the successor of
+		 * the dummy head, which becomes the new dummy, so only the thread that
+		 * advanced the head reads it. Returns false if the queue was empty.
+		 */
+		bool try_pop(T& out) {
+			typename Reclaimer::guard head_guard, next_guard;
+			for (;;) {
+				node_type* head = head_guard.protect(m_head);
+				node_type* next = next_guard.protect(head->next);
+				if (head != m_head.load()) continue;
+				if (!next) return false;
+
+				node_type* tail = m_tail.load();
+				if (head == tail) {
+					m_tail.compare_exchange_weak(tail, next);
+					continue;
+				}
+				if (m_head.compare_exchange_weak(head, next)) {
+					out = std::move(*next->val_ptr());
+					next->val_ptr()->~T();
+					head_guard.reset();
+					Reclaimer::retire(head);
+					return true;
+				}
+			}
+		}
+
+		/**
+		 * only a snapshot while other threads modify the queue
+		 */
+		bool empty() const {
+			typename Reclaimer::guard head_guard;
+			return !head_guard.protect(m_head)->next.load();
+		}
+
+	private:
+		alignas(64) std::atomic<node_type*> m_head;
+		alignas(64) std::atomic<node_type*> m_tail;
+	};
+
+	template <typename T>
+	class mpsc_queue {
+		typedef atomic_node<T> node_type;
+
+	public:
+		typedef T value_type;
+		typedef size_t size_type;
+
+		mpsc_queue() : m_head(&m_stub), m_tail(&m_stub) {}
+
+		mpsc_queue(const mpsc_queue&) = delete;
+
+		mpsc_queue& operator=(const mpsc_queue&) = delete;
+
+		/**
+		 * must not run concurrently with any other member
+		 */
+		~mpsc_queue() {
+			for (node_type* node; (node = pop_node());) {
+				node->val_ptr()->~T();
+				delete node;
+			}
+		}
+
+		void push(const T& value) { emplace(value); }
+
+		void push(T&& value) { emplace(std::move(value)); }
+
+		/**
+		 * wait free, may be called from any thread
+		 */
+		template <class... Args>
+		void emplace(Args&&... args) {
+			node_type* node = new node_type;
+			try {
+				::new (static_cast<void*>(node->val_ptr())) T(std::forward<Args>(args)...);
+			} catch (...) {
+				delete node;
+				throw;
+			}
+			push_node(node);
+		}
+
+		/**
+		 * Moves the front value into out, may only be called from the consumer
+		 * thread. Returns false if the queue is empty or a producer is between
+		 * its exchange and its link, in which case the value shows up shortly.
+		 */
+		bool try_pop(T& out) {
+			node_type* node = pop_node();
+			if (!node) return false;
+			out = std::move(*node->val_ptr());
+			node->val_ptr()->~T();
+			delete node;
+			return true;
+		}
+
+		/**
+		 * may only be called from the consumer thread
+		 */
+		bool empty() const {
+			const node_type* tail = m_tail;
+			if (tail == &m_stub) tail = tail->next.load(std::memory_order_acquire);
+			return !tail;
+		}
+
+	private:
+		alignas(64) std::atomic<node_type*> m_head;
+		alignas(64) node_type* m_tail;
+		node_type m_stub;
+
+		void push_node(node_type* node) {
+			node->next.store(nullptr, std::memory_order_relaxed);
+			node_type* prev = m_head.exchange(node, std::memory_order_acq_rel);
+			prev->next.store(node, std::memory_order_release);
+		}
+
+		node_type* pop_node() {
+			node_type* tail = m_tail;
+			node_type* next = tail->next.load(std::memory_order_acquire);
+			if (tail == &m_stub) {
+				if (!next) return nullptr;
+				m_tail = tail = next;
+				next = next->next.load(std::memory_order_acquire);
+			}
+			if (next) {
+				m_tail = next;
+				return tail;
+			}
+
+			// tail is the last linked node, put the stub behind it so it can be taken
+			if (tail != m_head.load(std::memory_order_acquire)) return nullptr;
+			push_node(&m_stub);
+			next = tail->next.load(std::memory_order_acquire);
+			if (next) {
+				m_tail = next;
+				return tail;
+			}
+			return nullptr;
+		}
+	};
+}
@@ -0,0 +1,91 @@
+/**
+ * Treiber stack
+ *
+ * Lock-free stack, push and pop swing the head with a single compare and
+ * swap. Popped nodes are handed to the Reclaimer, which also rules out the ABA
+ * problem since a node cannot be reused while another thread still holds it.
+ */
+#include "atomic_node.cpp"
+#include "epoch.cpp"
+#include "hazard_pointer.cpp"
+
+#include <stddef.h>
+#include <atomic>
+#include <utility>
+
+namespace ds {
+
+	template <typename T, class Reclaimer = hazard_pointers>
+	class treiber_stack {
+		typedef atomic_node<T> node_type;
+
+	public:
+		typedef T value_type;
+		typedef size_t size_type;
+
+		treiber_stack() : m_head(nullptr) {}
+
+		treiber_stack(const treiber_stack&) = delete;
+
+		treiber_stack& operator=(const treiber_stack&) = delete;
+
+		/**
+		 * must not run concurrently with any other member
+		 */
+		~treiber_stack() {
+			for (node_type* node = m_head.load(std::memory_order_relaxed); node;) {
+				node_type* next = node->next.load(std::memory_order_relaxed);
+				node->val_ptr()->~T();
+				delete node;
+				node = next;
+			}
+		}
+
+		void push(const T& value) { emplace(value); }
+
+		void push(T&& value) { emplace(std::move(value)); }
+
+		template <class... Args>
+		void emplace(Args&&... args) {
+			node_type* node = new node_type;
+			try {
+				::new (static_cast<void*>(node->val_ptr())) T(std::forward<Args>(args)...);
+			} catch (...) {
+				delete node;
+				throw;
+			}
+
+			node_type* head = m_head.load(std::memory_order_relaxed);
+			do {
+				node->next.store(head, std::memory_order_relaxed);
+			} while (!m_head.compare_exchange_weak(head, node, std::memory_order_release, std::memory_order_relaxed));
+		}
+
+		/**
+		 * moves the top value into out, returns false if the stack was empty
+		 */
+		bool try_pop(T& out) {
+			typename Reclaimer::guard head_guard;
+			for (;;) {
+				node_type* head = head_guard.protect(m_head);
+				if (!head) return false;
+				node_type* next = head->next.load(std::memory_order_relaxed);
+				if (m_head.compare_exchange_weak(head, next, std::memory_order_acquire, std::memory_order_relaxed)) {
+					out = std::move(*head->val_ptr());
+					head->val_ptr()->~T();
+					head_guard.reset();
+					Reclaimer::retire(head);
+					return true;
+				}
+			}
+		}
+
+		/**
+		 * only a snapshot while other threads modify the stack
+		 */
+		bool empty() const { return !m_head.load(); }
+
+	private:
+		alignas(64) std::atomic<node_type*> m_head;
+	};
+}
@@ -0,0 +1,98 @@
+/**
+ * Eytzinger search index
+ *
+ * A copy of a sorted array laid out in breadth first order of the implicit
+ * binary search tree, so the children of slot k are 2k and 2k + 1. The first
+ * levels of every search share the same few cache lines, the descent needs no
+ * branch on the comparison, and the slots needed four levels down are
+ * contiguous and can be prefetched while the current level is compared.
+ */
+#pragma once
+
+#include "../vector/Vector.cpp"
+
+#include <stddef.h>
+
+namespace ds {
+
+	template <class Key, class Compare>
+	class eytzinger_index {
+	public:
+		typedef size_t size_type;
+
+		/**
+		 * lays out sorted[0, n) again, replacing the previous contents
+		 */
+		void build(const Key* sorted, size_type n) {
+			m_keys.clear();
+			m_ranks.clear();
+			m_keys.reserve(n);
+			m_ranks.resize(n);
+			size_type rank = 0;
+			assign_ranks(1, n, rank);
+			for (size_type k = 1; k <= n; ++k)
+				m_keys.push_back(sorted[m_ranks[k - 1]]);
+		}
+
+		void clear() {
+			m_keys.clear();
+			m_ranks.clear();
+		}
+
+		void swap(eytzinger_index& other) {
+			m_keys.swap(other.m_keys);
+			m_ranks.swap(other.m_ranks);
+		}
+
+		/**
+		 * rank in the sorted array of the first key not less than key
+		 */
+		template <class K>
+		size_type lower_bound(const K& key, const Compare& comp) const {
+			return descend([&](const Key& slot) { return comp(slot, key); });
+		}
+
+		/**
+		 * rank in the sorted array of the first key greater than key
+		 */
+		template <class K>
+		size_type upper_bound(const K& key, const Compare& comp) const {
+			return descend([&](const Key& slot) { return !comp(key, slot); });
+		}
+
+	private:
+		// slot k of the tree is m_keys[k - 1]
+		Vector<Key> m_keys;
+		// sorted position of each slot
+		Vector<size_type> m_ranks;
+
+		/**
+		 * Walks down while before(slot) holds, going right on true. The path
+		 * encodes every turn in the bits of k; the last left turn is the answer,
+		 * found by shifting off the trailing right turns and that left turn.
+		 */
+		template <class Before>
+		size_type descend(Before before) const {
+			const size_type n = m_keys.size();
+			const Key* keys = m_keys.data();
+			size_type k = 1;
+			while (k <= n) {
+				// the sixteen slots four levels below k are adjacent
+				if (16*k <= n) __builtin_prefetch(keys + 16*k - 1);
+				k = 2*k + before(keys[k - 1]);
+			}
+			k >>= __builtin_ffsll(static_cast<long long>(~k));
+			return k ? m_ranks[k - 1] : n;
+		}
+
+		/**
+		 * numbers the slots of the subtree at k in order, starting from rank
+		 */
+		void assign_ranks(size_type k, size_type n, size_type& rank) {
+			if (k > n) return;
+			assign_ranks(2*k, n, rank);
+			m_ranks[k - 1] = rank++;
+			assign_ranks(2*k + 1, n, rank);
+		}
+	};
+}
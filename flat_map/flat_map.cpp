@@ -0,0 +1,377 @@
+/**
+ * Flat map
+ *
+ * Sorted map over two Vectors, one of keys and one of values, for maps that
+ * are built once and read many times. Lookups search an Eytzinger copy of the
+ * keys instead of the sorted array, trading a second copy of the keys for
+ * searches that stay within a few cache lines. Iteration walks the sorted
+ * arrays.
+ *
+ * Inserting or erasing one element is O(n) and rebuilds the index, so bulk
+ * loads should go through insert_range, which sorts and merges once.
+ */
+#include "eytzinger.cpp"
+
+#include <stddef.h>
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace ds {
+
+	template <class Key, class T, class Compare = std::less<Key>>
+	class flat_map {
+	public:
+		typedef Key key_type;
+		typedef T mapped_type;
+		typedef std::pair<Key, T> value_type;
+		typedef Compare key_compare;
+		typedef size_t size_type;
+		typedef ptrdiff_t difference_type;
+		typedef std::pair<const Key&, T&> reference;
+		typedef std::pair<const Key&, const T&> const_reference;
+
+		/**
+		 * Random access iterator over both arrays. Dereferencing yields a pair
+		 * of references rather than a real reference, like ds::soa_vector.
+		 */
+		template <bool is_const>
+		class basic_iterator {
+			typedef typename std::conditional<is_const, const flat_map*, flat_map*>::type map_pointer;
+
+		public:
+			typedef std::random_access_iterator_tag iterator_category;
+			typedef std::pair<Key, T> value_type;
+			typedef ptrdiff_t difference_type;
+			typedef typename std::conditional<is_const, std::pair<const Key&, const T&>, std::pair<const Key&, T&>>::type reference;
+			typedef void pointer;
+
+			basic_iterator() : m_map(), m_index() {}
+
+			basic_iterator(map_pointer map, size_type index) : m_map(map), m_index(index) {}
+
+			template <bool other_const, class = typename std::enable_if<is_const && !other_const>::type>
+			basic_iterator(const basic_iterator<other_const>& other) : m_map(other.m_map), m_index(other.m_index) {}
+
+			reference operator*() const { return reference(m_map->m_keys[m_index], m_map->m_values[m_index]); }
+
+			reference operator[](difference_type n) const { return *(*this + n); }
+
+			const Key& key() const { return m_map->m_keys[m_index]; }
+
+			typename std::conditional<is_const, const T&, T&>::type value() const { return m_map->m_values[m_index]; }
+
+			basic_iterator& operator++() {
+				++m_index;
+				return *this;
+			}
+
+			basic_iterator operator++(int) { return basic_iterator(m_map, m_index++); }
+
+			basic_iterator& operator--() {
+				--m_index;
+				return *this;
+			}
+
+			basic_iterator operator--(int) { return basic_iterator(m_map, m_index--); }
+
+			basic_iterator& operator+=(difference_type n) {
+				m_index += n;
+				return *this;
+			}
+
+			basic_iterator& operator-=(difference_type n) {
+				m_index -= n;
+				return *this;
+			}
+
+			basic_iterator operator+(difference_type n) const { return basic_iterator(m_map, m_index + n); }
+
+			basic_iterator operator-(difference_type n) const { return basic_iterator(m_map, m_index - n); }
+
+			difference_type operator-(const basic_iterator& rhs) const { return m_index - rhs.m_index; }
+
+			bool operator==(const basic_iterator& rhs) const { return m_index == rhs.m_index; }
+
+			bool operator!=(const basic_iterator& rhs) const { return m_index != rhs.m_index; }
+
+			bool operator<(const basic_iterator& rhs) const { return m_index < rhs.m_index; }
+
+			bool operator>(const basic_iterator& rhs) const { return m_index > rhs.m_index; }
+
+			bool operator<=(const basic_iterator& rhs) const { return m_index <= rhs.m_index; }
+
+			bool operator>=(const basic_iterator& rhs) const { return m_index >= rhs.m_index; }
+
+		private:
+			friend class flat_map;
+
+			map_pointer m_map;
+			size_type m_index;
+		};
+
+		typedef basic_iterator<false> iterator;
+		typedef basic_iterator<true> const_iterator;
+
+		// Constructors
+
+		explicit flat_map(const key_compare& comp = key_compare()) : m_comp(comp) {}
+
+		template <class InputIterator, class = typename std::iterator_traits<InputIterator>::iterator_category>
+		flat_map(InputIterator first, InputIterator last, const key_compare& comp = key_compare()) : m_comp(comp) {
+			insert_range(first, last);
+		}
+
+		flat_map(std::initializer_list<value_type> il, const key_compare& comp = key_compare()) : m_comp(comp) {
+			insert_range(il.begin(), il.end());
+		}
+
+		// Iterators
+
+		iterator begin() { return iterator(this, 0); }
+
+		const_iterator begin() const { return const_iterator(this, 0); }
+
+		const_iterator cbegin() const { return begin(); }
+
+		iterator end() { return iterator(this, size()); }
+
+		const_iterator end() const { return const_iterator(this, size()); }
+
+		const_iterator cend() const { return end(); }
+
+		// Capacity
+
+		size_type size() const { return m_keys.size(); }
+
+		bool empty() const { return m_keys.empty(); }
+
+		void reserve(size_type n) {
+			m_keys.reserve(n);
+			m_values.reserve(n);
+		}
+
+		/**
+		 * the keys in sorted order
+		 */
+		const Vector<Key>& keys() const { return m_keys; }
+
+		/**
+		 * the values in the order of their keys
+		 */
+		const Vector<T>& values() const { return m_values; }
+
+		// Element access
+
+		T& at(const key_type& key) {
+			const size_type rank = find_rank(key);
+			if (rank == size()) throw std::out_of_range("ds::flat_map::at");
+			return m_values[rank];
+		}
+
+		const T& at(const key_type& key) const {
+			const size_type rank = find_rank(key);
+			if (rank == size()) throw std::out_of_range("ds::flat_map::at");
+			return m_values[rank];
+		}
+
+		T& operator[](const key_type& key) { return try_emplace(key).first.value(); }
+
+		// Lookup
+
+		iterator find(const key_type& key) { return iterator(this, find_rank(key)); }
+
+		const_iterator find(const key_type& key) const { return const_iterator(this, find_rank(key)); }
+
+		bool contains(const key_type& key) const { return find_rank(key) != size(); }
+
+		size_type count(const key_type& key) const { return contains(key) ? 1 : 0; }
+
+		iterator lower_bound(const key_type& key) { return iterator(this, m_index.lower_bound(key, m_comp)); }
+
+		const_iterator lower_bound(const key_type& key) const {
+			return const_iterator(this, m_index.lower_bound(key, m_comp));
+		}
+
+		iterator upper_bound(const key_type& key) { return iterator(this, m_index.upper_bound(key, m_comp)); }
+
+		const_iterator upper_bound(const key_type& key) const {
+			return const_iterator(this, m_index.upper_bound(key, m_comp));
+		}
+
+		std::pair<iterator, iterator> equal_range(const key_type& key) {
+			const iterator first = lower_bound(key);
+			return std::make_pair(first, iterator(this, first.m_index + count_at(first.m_index, key)));
+		}
+
+		std::pair<const_iterator, const_iterator> equal_range(const key_type& key) const {
+			const const_iterator first = lower_bound(key);
+			return std::make_pair(first, const_iterator(this, first.m_index + count_at(first.m_index, key)));
+		}
+
+		key_compare key_comp() const { return m_comp; }
+
+		// Modifiers
+
+		/**
+		 * inserts (key, T(args...)) if key is absent, returns the element and
+		 * whether it was inserted
+		 */
+		template <class... Args>
+		std::pair<iterator, bool> try_emplace(const key_type& key, Args&&... args) {
+			const size_type rank = m_index.lower_bound(key, m_comp);
+			if (count_at(rank, key)) return std::make_pair(iterator(this, rank), false);
+
+			m_values.emplace(m_values.begin() + rank, std::forward<Args>(args)...);
+			try {
+				m_keys.emplace(m_keys.begin() + rank, key);
+			} catch (...) {
+				m_values.erase(m_values.begin() + rank);
+				throw;
+			}
+			rebuild_index();
+			return std::make_pair(iterator(this, rank), true);
+		}
+
+		std::pair<iterator, bool> insert(const value_type& val) { return try_emplace(val.first, val.second); }
+
+		template <class M>
+		std::pair<iterator, bool> insert_or_assign(const key_type& key, M&& obj) {
+			std::pair<iterator, bool> result = try_emplace(key, std::forward<M>(obj));
+			if (!result.second) result.first.value() = std::forward<M>(obj);
+			return result;
+		}
+
+		/**
+		 * @brief inserts every element of [first, last) whose key is absent
+		 *
+		 * Sorts the new elements on their own, then merges them with the
+		 * existing ones in one pass and rebuilds the index once. Of several new
+		 * elements with the same key the first one is kept, and existing
+		 * elements are never replaced, as with repeated insert.
+		 */
+		template <class InputIterator>
+		void insert_range(InputIterator first, InputIterator last) {
+			Vector<value_type> incoming;
+			for (; first != last; ++first)
+				incoming.push_back(*first);
+			if (incoming.empty()) return;
+
+			std::stable_sort(incoming.begin(), incoming.end(),
+				[this](const value_type& lhs, const value_type& rhs) { return m_comp(lhs.first, rhs.first); });
+			incoming.erase(std::unique(incoming.begin(), incoming.end(),
+				[this](const value_type& lhs, const value_type& rhs) { return !m_comp(lhs.first, rhs.first); }),
+				incoming.end());
+
+			Vector<Key> keys;
+			Vector<T> values;
+			keys.reserve(size() + incoming.size());
+			values.reserve(size() + incoming.size());
+
+			size_type old = 0;
+			for (size_type n = 0; n < incoming.size(); ++n) {
+				Key& key = incoming[n].first;
+				for (; old < size() && m_comp(m_keys[old], key); ++old) {
+					keys.push_back(std::move(m_keys[old]));
+					values.push_back(std::move(m_values[old]));
+				}
+				if (old < size() && !m_comp(key, m_keys[old])) continue;
+				keys.push_back(std::move(key));
+				values.push_back(std::move(incoming[n].second));
+			}
+			for (; old < size(); ++old) {
+				keys.push_back(std::move(m_keys[old]));
+				values.push_back(std::move(m_values[old]));
+			}
+
+			m_keys.swap(keys);
+			m_values.swap(values);
+			rebuild_index();
+		}
+
+		template <class InputIterator>
+		void insert(InputIterator first, InputIterator last) { insert_range(first, last); }
+
+		void insert(std::initializer_list<value_type> il) { insert_range(il.begin(), il.end()); }
+
+		iterator erase(const_iterator position) {
+			const size_type rank = position.m_index;
+			m_keys.erase(m_keys.begin() + rank);
+			m_values.erase(m_values.begin() + rank);
+			rebuild_index();
+			return iterator(this, rank);
+		}
+
+		iterator erase(const_iterator first, const_iterator last) {
+			m_keys.erase(m_keys.begin() + first.m_index, m_keys.begin() + last.m_index);
+			m_values.erase(m_values.begin() + first.m_index, m_values.begin() + last.m_index);
+			rebuild_index();
+			return iterator(this, first.m_index);
+		}
+
+		size_type erase(const key_type& key) {
+			const size_type rank = find_rank(key);
+			if (rank == size()) return 0;
+			erase(const_iterator(this, rank));
+			return 1;
+		}
+
+		void clear() {
+			m_keys.clear();
+			m_values.clear();
+			m_index.clear();
+		}
+
+		void swap(flat_map& other) {
+			m_keys.swap(other.m_keys);
+			m_values.swap(other.m_values);
+			m_index.swap(other.m_index);
+			std::swap(m_comp, other.m_comp);
+		}
+
+	private:
+		Vector<Key> m_keys;
+		Vector<T> m_values;
+		eytzinger_index<Key, Compare> m_index;
+		key_compare m_comp;
+
+		void rebuild_index() { m_index.build(m_keys.data(), m_keys.size()); }
+
+		/**
+		 * 1 if the element at rank holds key, 0 otherwise
+		 */
+		size_type count_at(size_type rank, const key_type& key) const {
+			return rank < size() && !m_comp(key, m_keys[rank]) ? 1 : 0;
+		}
+
+		/**
+		 * rank of key, or size() if absent
+		 */
+		size_type find_rank(const key_type& key) const {
+			const size_type rank = m_index.lower_bound(key, m_comp);
+			return count_at(rank, key) ? rank : size();
+		}
+	};
+
+	template <class Key, class T, class Compare>
+	bool operator==(const flat_map<Key, T, Compare>& lhs, const flat_map<Key, T, Compare>& rhs) {
+		return lhs.size() == rhs.size() && std::equal(lhs.keys().begin(), lhs.keys().end(), rhs.keys().begin())
+		       && std::equal(lhs.values().begin(), lhs.values().end(), rhs.values().begin());
+	}
+
+	template <class Key, class T, class Compare>
+	bool operator!=(const flat_map<Key, T, Compare>& lhs, const flat_map<Key, T, Compare>& rhs) {
+		return !(lhs == rhs);
+	}
+}
+
+namespace std {
+	template <class Key, class T, class Compare>
+	void swap(ds::flat_map<Key, T, Compare>& lhs, ds::flat_map<Key, T, Compare>& rhs) {
+		lhs.swap(rhs);
+	}
+}
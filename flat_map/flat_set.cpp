@@ -0,0 +1,212 @@
+/**
+ * Flat set
+ *
+ * Sorted set over a Vector of keys, searched through an Eytzinger copy of the
+ * keys like ds::flat_map. Iterators are the sorted Vector's const iterators.
+ */
+#include "eytzinger.cpp"
+
+#include <stddef.h>
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <utility>
+
+namespace ds {
+
+	template <class Key, class Compare = std::less<Key>>
+	class flat_set {
+	public:
+		typedef Key key_type;
+		typedef Key value_type;
+		typedef Compare key_compare;
+		typedef Compare value_compare;
+		typedef size_t size_type;
+		typedef ptrdiff_t difference_type;
+		typedef const Key& reference;
+		typedef const Key& const_reference;
+		typedef typename Vector<Key>::const_iterator iterator;
+		typedef typename Vector<Key>::const_iterator const_iterator;
+
+		// Constructors
+
+		explicit flat_set(const key_compare& comp = key_compare()) : m_comp(comp) {}
+
+		template <class InputIterator, class = typename std::iterator_traits<InputIterator>::iterator_category>
+		flat_set(InputIterator first, InputIterator last, const key_compare& comp = key_compare()) : m_comp(comp) {
+			insert_range(first, last);
+		}
+
+		flat_set(std::initializer_list<value_type> il, const key_compare& comp = key_compare()) : m_comp(comp) {
+			insert_range(il.begin(), il.end());
+		}
+
+		// Iterators
+
+		const_iterator begin() const { return m_keys.begin(); }
+
+		const_iterator cbegin() const { return begin(); }
+
+		const_iterator end() const { return m_keys.end(); }
+
+		const_iterator cend() const { return end(); }
+
+		// Capacity
+
+		size_type size() const { return m_keys.size(); }
+
+		bool empty() const { return m_keys.empty(); }
+
+		void reserve(size_type n) { m_keys.reserve(n); }
+
+		/**
+		 * the keys in sorted order
+		 */
+		const Vector<Key>& keys() const { return m_keys; }
+
+		// Lookup
+
+		const_iterator find(const key_type& key) const { return begin() + find_rank(key); }
+
+		bool contains(const key_type& key) const { return find_rank(key) != size(); }
+
+		size_type count(const key_type& key) const { return contains(key) ? 1 : 0; }
+
+		const_iterator lower_bound(const key_type& key) const { return begin() + m_index.lower_bound(key, m_comp); }
+
+		const_iterator upper_bound(const key_type& key) const { return begin() + m_index.upper_bound(key, m_comp); }
+
+		std::pair<const_iterator, const_iterator> equal_range(const key_type& key) const {
+			const size_type rank = m_index.lower_bound(key, m_comp);
+			return std::make_pair(begin() + rank, begin() + rank + count_at(rank, key));
+		}
+
+		key_compare key_comp() const { return m_comp; }
+
+		value_compare value_comp() const { return m_comp; }
+
+		// Modifiers
+
+		template <class... Args>
+		std::pair<const_iterator, bool> emplace(Args&&... args) {
+			value_type key(std::forward<Args>(args)...);
+			const size_type rank = m_index.lower_bound(key, m_comp);
+			if (count_at(rank, key)) return std::make_pair(begin() + rank, false);
+
+			m_keys.emplace(m_keys.begin() + rank, std::move(key));
+			rebuild_index();
+			return std::make_pair(begin() + rank, true);
+		}
+
+		std::pair<const_iterator, bool> insert(const value_type& key) { return emplace(key); }
+
+		std::pair<const_iterator, bool> insert(value_type&& key) { return emplace(std::move(key)); }
+
+		/**
+		 * @brief inserts every key of [first, last) that is absent
+		 *
+		 * Sorts and deduplicates the new keys, merges them with the existing
+		 * ones in one pass and rebuilds the index once.
+		 */
+		template <class InputIterator>
+		void insert_range(InputIterator first, InputIterator last) {
+			Vector<Key> incoming;
+			for (; first != last; ++first)
+				incoming.push_back(*first);
+			if (incoming.empty()) return;
+
+			std::sort(incoming.begin(), incoming.end(), m_comp);
+			incoming.erase(std::unique(incoming.begin(), incoming.end(),
+				[this](const Key& lhs, const Key& rhs) { return !m_comp(lhs, rhs); }),
+				incoming.end());
+
+			Vector<Key> keys;
+			keys.reserve(size() + incoming.size());
+
+			size_type old = 0;
+			for (size_type n = 0; n < incoming.size(); ++n) {
+				Key& key = incoming[n];
+				for (; old < size() && m_comp(m_keys[old], key); ++old)
+					keys.push_back(std::move(m_keys[old]));
+				if (old < size() && !m_comp(key, m_keys[old])) continue;
+				keys.push_back(std::move(key));
+			}
+			for (; old < size(); ++old)
+				keys.push_back(std::move(m_keys[old]));
+
+			m_keys.swap(keys);
+			rebuild_index();
+		}
+
+		template <class InputIterator>
+		void insert(InputIterator first, InputIterator last) { insert_range(first, last); }
+
+		void insert(std::initializer_list<value_type> il) { insert_range(il.begin(), il.end()); }
+
+		const_iterator erase(const_iterator position) {
+			const size_type rank = position - begin();
+			m_keys.erase(position);
+			rebuild_index();
+			return begin() + rank;
+		}
+
+		const_iterator erase(const_iterator first, const_iterator last) {
+			const size_type rank = first - begin();
+			m_keys.erase(first, last);
+			rebuild_index();
+			return begin() + rank;
+		}
+
+		size_type erase(const key_type& key) {
+			const size_type rank = find_rank(key);
+			if (rank == size()) return 0;
+			erase(begin() + rank);
+			return 1;
+		}
+
+		void clear() {
+			m_keys.clear();
+			m_index.clear();
+		}
+
+		void swap(flat_set& other) {
+			m_keys.swap(other.m_keys);
+			m_index.swap(other.m_index);
+			std::swap(m_comp, other.m_comp);
+		}
+
+	private:
+		Vector<Key> m_keys;
+		eytzinger_index<Key, Compare> m_index;
+		key_compare m_comp;
+
+		void rebuild_index() { m_index.build(m_keys.data(), m_keys.size()); }
+
+		size_type count_at(size_type rank, const key_type& key) const {
+			return rank < size() && !m_comp(key, m_keys[rank]) ? 1 : 0;
+		}
+
+		size_type find_rank(const key_type& key) const {
+			const size_type rank = m_index.lower_bound(key, m_comp);
+			return count_at(rank, key) ? rank : size();
+		}
+	};
+
+	template <class Key, class Compare>
+	bool operator==(const flat_set<Key, Compare>& lhs, const flat_set<Key, Compare>& rhs) {
+		return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+	}
+
+	template <class Key, class Compare>
+	bool operator!=(const flat_set<Key, Compare>& lhs, const flat_set<Key, Compare>& rhs) {
+		return !(lhs == rhs);
+	}
+}
+
+namespace std {
+	template <class Key, class Compare>
+	void swap(ds::flat_set<Key, Compare>& lhs, ds::flat_set<Key, Compare>& rhs) {
+		lhs.swap(rhs);
+	}
+}
@@ -0,0 +1,90 @@
+/**
+ * Merge sort of singly linked chains
+ *
+ * Shared by Forward_list, List and the intrusive lists. A chain is a null
+ * terminated sequence of nodes linked through a next member of the node
+ * pointer type; only next pointers are changed, so doubly linked lists
+ * restore their previous pointers afterwards. less(a, b) compares the
+ * elements of two nodes.
+ */
+#pragma once
+
+#include <stddef.h>
+
+namespace ds {
+namespace detail {
+
+	/**
+	 * @brief merges two sorted chains, nodes of first go before equivalent
+	 * nodes of second
+	 * @return the first node of the merged chain
+	 */
+	template <class NodePtr, class Less>
+	NodePtr merge_chains(NodePtr first, NodePtr second, Less& less) {
+		NodePtr head = nullptr;
+		NodePtr* tail = &head;
+		while (first && second) {
+			if (less(second, first)) {
+				*tail = second;
+				second = second->next;
+			} else {
+				*tail = first;
+				first = first->next;
+			}
+			tail = &(*tail)->next;
+		}
+		*tail = first ? first : second;
+		return head;
+	}
+
+	/**
+	 * @brief stable bottom up merge sort of a chain
+	 *
+	 * The input is cut into its natural runs (strictly descending runs are
+	 * reversed), so presorted input is handled in linear time. bins[i] holds
+	 * the merge of 2^i runs, and each new run is carried through the bins like
+	 * a binary counter, which keeps the merges balanced.
+	 */
+	template <class NodePtr, class Less>
+	NodePtr sort_chain(NodePtr head, Less& less) {
+		NodePtr bins[64] = {};
+		size_t bin_count = 0;
+
+		while (head) {
+			NodePtr run = head;
+			head = head->next;
+			run->next = nullptr;
+
+			if (head && less(head, run)) {
+				while (head && less(head, run)) {
+					NodePtr next = head->next;
+					head->next = run;
+					run = head;
+					head = next;
+				}
+			} else {
+				NodePtr tail = run;
+				while (head && !less(head, tail)) {
+					tail->next = head;
+					tail = head;
+					head = head->next;
+				}
+				tail->next = nullptr;
+			}
+
+			size_t bin = 0;
+			for (; bin < bin_count && bins[bin]; ++bin) {
+				run = merge_chains(bins[bin], run, less);
+				bins[bin] = nullptr;
+			}
+			if (bin == bin_count) ++bin_count;
+			bins[bin] = run;
+		}
+
+		NodePtr sorted = nullptr;
+		for (size_t bin = 0; bin < bin_count; ++bin)
+			if (bins[bin]) sorted = merge_chains(bins[bin], sorted, less);
+		return sorted;
+	}
+}
+}
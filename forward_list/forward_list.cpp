@@ -5,12 +5,17 @@
  * @version 0.1 18/8/18
  */
 
+#include "chain_sort.cpp"
+
 #include <stddef.h>
+#include <algorithm>
 #include <memory>
 #include <initializer_list>
 #include <iterator>
 #include <utility>
 #include <type_traits>
+#include <functional>
+#include <vector>
  
 template<typename T, typename = void>
 struct is_iterator {
@@ -211,8 +216,35 @@ public:
 	const Node<value_type>* m_node;
 };
 
-template <typename T, typename Allocator = std::allocator<T>>
-class Forward_list {
+/**
+ * @brief element count kept by Forward_list when size tracking is enabled
+ */
+template <bool track_size>
+class Forward_list_size {
+protected:
+	size_t stored_size() const { return 0; }
+	void add_size(size_t) {}
+	void sub_size(size_t) {}
+	void swap_size(Forward_list_size&) {}
+};
+
+template <>
+class Forward_list_size<true> {
+protected:
+	size_t stored_size() const { return m_size; }
+	void add_size(size_t count) { m_size += count; }
+	void sub_size(size_t count) { m_size -= count; }
+	void swap_size(Forward_list_size& other) { std::swap(m_size, other.m_size); }
+
+	size_t m_size = 0;
+};
+
+/**
+ * With track_size set the list keeps its length up to date through every
+ * modifier, so size() is O(1) at the cost of one extra word per list.
+ */
+template <typename T, typename Allocator = std::allocator<T>, bool track_size = false>
+class Forward_list : private Forward_list_size<track_size> {
 
 	using Alloc_traits = std::allocator_traits<Allocator>;
 
@@ -239,20 +271,18 @@ public:
 		m_head = new Node<value_type>();
 	}
 	
-	explicit Forward_list(const allocator_type& alloc) : m_head(), m_allocator(alloc) {}
+	explicit Forward_list(const allocator_type& alloc) : m_allocator(alloc) {
+		m_head = new Node<value_type>();
+	}
 	
 	Forward_list(size_type count, const value_type& val, const allocator_type& alloc) : m_allocator(alloc) {
 		m_head = new Node<value_type>();
-		for (size_type n = 0; n < count; n++) {
-			push_front(val);
-		}
+		insert_after(cbefore_begin(), count, val);
 	}
 	
 	explicit Forward_list(size_type count, const allocator_type& alloc = allocator_type()) : m_allocator(alloc) {
 		m_head = new Node<value_type>();
-		for (size_type n = 0; n < count; n++) {
-			emplace_front();
-		}
+		resize(count);
 	}
 	
 	template <class InputIterator, class = typename std::enable_if<is_iterator<InputIterator>::value>::type>
@@ -271,13 +301,18 @@ public:
 		insert_after(cbefore_begin(), other.begin(), other.end());
 	}
 	
-	Forward_list(Forward_list&& other) {
-		m_head = other.m_head;
-		m_allocator = other.m_allocator;
+	Forward_list(Forward_list&& other) : m_allocator(other.m_allocator) {
+		m_head = new Node<value_type>();
+		std::swap(m_head, other.m_head);
+		std::swap(m_slabs, other.m_slabs);
+		this->swap_size(other);
 	}
 	
 	Forward_list(Forward_list&& other, const allocator_type& alloc) : m_allocator(alloc) {
-		m_head = std::move(other.m_head);
+		m_head = new Node<value_type>();
+		std::swap(m_head, other.m_head);
+		std::swap(m_slabs, other.m_slabs);
+		this->swap_size(other);
 	}
 	
 	Forward_list(std::initializer_list<value_type> il, const allocator_type& alloc = allocator_type()) : m_allocator(alloc) {
@@ -292,22 +327,23 @@ public:
 	
 	Forward_list& operator=(const Forward_list& other) {
 		clear();
-		insert_after(cbefore_begin(), other.cbefore_begin(), other.cend());
+		insert_after(cbefore_begin(), other.cbegin(), other.cend());
+		return *this;
 	}
 	
 	Forward_list& operator=(Forward_list&& other) {
 		this->swap(other);
+		return *this;
 	}
 	
 	Forward_list& operator=(std::initializer_list<value_type> il) {
 		assign(il);
+		return *this;
 	}
 	
 	void assign(size_type count, const value_type& val) {
 		clear();
-		for(size_type n = 0; n < count; n++) {
-			push_front(val);
-		}
+		insert_after(cbefore_begin(), count, val);
 	}
 	
 	template <class InputIterator, class = typename std::enable_if<is_iterator<InputIterator>::value>::type>
@@ -379,22 +415,41 @@ public:
 		return m_head->next == nullptr;
 	}
 	
+	/**
+	 * @brief number of elements, O(1) with track_size and a walk otherwise
+	 */
+	size_type size() const {
+		if (track_size) {
+			return this->stored_size();
+		}
+		size_type count = 0;
+		for (const Node<value_type>* node = m_head->next; node != nullptr; node = node->next) {
+			++count;
+		}
+		return count;
+	}
+	
 	size_type max_size() const {
 		return Alloc_traits::max_size(m_allocator);
 	}
 	
 	// Modifiers
 	
+	/**
+	 * @brief destroys every element and drops the list's references to its slabs
+	 */
 	void clear() {
 		while (!empty()) {
 			pop_front();
 		}
+		m_slabs.clear();
 	}
 	
 	iterator insert_after(const_iterator pos, const value_type& val) {
 		Node<value_type>* iterator_node = const_cast<Node<value_type>*>(pos.m_node);
 		iterator_node->next = new Node(iterator_node->next);
 		Alloc_traits::construct(m_allocator, iterator_node->next->val_ptr(), val);
+		this->add_size(1);
 		return iterator(iterator_node->next);
 	}
 	
@@ -402,10 +457,16 @@ public:
 		Node<value_type>* iterator_node = const_cast<Node<value_type>*>(pos.m_node);
 		iterator_node->next = new Node(iterator_node->next);
 		Alloc_traits::construct(m_allocator, iterator_node->next->val_ptr(), std::move(val));
+		this->add_size(1);
 		return iterator(iterator_node->next);
 	}
 	
 	iterator insert_after(const_iterator pos, size_type count, const value_type& val) {
+		if (count >= slab_threshold) {
+			return insert_slab(pos, count, [&](value_type* ptr) {
+				Alloc_traits::construct(m_allocator, ptr, val);
+			});
+		}
 		iterator it(const_cast<Node<value_type>*>(pos.m_node));
 		for (size_type i = 0; i < count; i++, it++) {
 			insert_after(it, val);
@@ -415,19 +476,11 @@ public:
 	
 	template <class InputIterator, class = typename std::enable_if<is_iterator<InputIterator>::value>::type>
 	iterator insert_after(const_iterator pos, InputIterator first, InputIterator last) {
-		iterator list_it(const_cast<Node<value_type>*>(pos.m_node));
-		for (InputIterator it = first; it != last; it++, list_it++) {
-			insert_after(list_it, *it);
-		}
-		return list_it;
+		return insert_range(pos, first, last, typename std::iterator_traits<InputIterator>::iterator_category());
 	}
 	
 	iterator insert_after(const_iterator pos, std::initializer_list<value_type> il) {
-		iterator list_it(const_cast<Node<value_type>*>(pos.m_node));
-		for ( typename std::initializer_list<value_type>::iterator it = il.begin(); it != il.end(); it++, list_it++) {
-			insert_after(list_it, *it);
-		}
-		return list_it;
+		return insert_after(pos, il.begin(), il.end());
 	}
 
 	template <class... Args>
@@ -435,6 +488,7 @@ public:
 		Node<value_type>* iterator_node = const_cast<Node<value_type>*>(pos.m_node);
 		iterator_node->next = new Node(iterator_node->next);
 		Alloc_traits::construct(m_allocator, iterator_node->next->val_ptr(), std::forward<Args>(args)...);
+		this->add_size(1);
 		return iterator(iterator_node->next);
 	}
 	
@@ -444,7 +498,8 @@ public:
 			Node<value_type>* tmp = node->next;
 			node->next = node->next->next;
 			Alloc_traits::destroy(m_allocator, tmp->val_ptr());
-			delete tmp;
+			deallocate_node(tmp);
+			this->sub_size(1);
 		}
 		return iterator(node->next);
 	}
@@ -456,28 +511,33 @@ public:
 				Node<value_type>* tmp = node->next;
 				node->next = node->next->next;
 				Alloc_traits::destroy(m_allocator, tmp->val_ptr());
-				delete tmp;
+				deallocate_node(tmp);
+				this->sub_size(1);
 			} else {
 				break;
 			}
 		}
-		return iterator(node);
+		return iterator(node->next);
 	}
 	
 	void push_front(const value_type& val) {
 		m_head->next = new Node(m_head->next);
 		Alloc_traits::construct(m_allocator, m_head->next->val_ptr(), val);
+		this->add_size(1);
 	}
 	
 	void push_front(value_type&& val) {
 		m_head->next = new Node(m_head->next);
 		Alloc_traits::construct(m_allocator, m_head->next->val_ptr(), std::move(val));
+		this->add_size(1);
 	}
 	
 	template <class... Args>
 	reference emplace_front(Args&&... args) {
 		m_head->next = new Node(m_head->next);
 		Alloc_traits::construct(m_allocator, m_head->next->val_ptr(), std::forward<Args>(args)...);
+		this->add_size(1);
+		return *(m_head->next->val_ptr());
 	}
 
 	void pop_front() {
@@ -485,135 +545,203 @@ public:
 			Node<value_type>* tmp = m_head->next;
 			m_head->next = m_head->next->next;
 			Alloc_traits::destroy(m_allocator, tmp->val_ptr());
-			delete tmp;
+			deallocate_node(tmp);
+			this->sub_size(1);
 		}
 	}
 	
 	void resize(size_type count) {
-		const_iterator it = begin();
-		for (size_type n = 1; n < count; n++, it++) {
-			if (it.m_node->next == nullptr) {
-				insert_after(it, count-n, value_type());
-				return;
-			}
+		if (track_size && count == size()) {
+			return;
 		}
-		
-		if (it.m_node->next != nullptr) {
-			erase_after(it, end());
+		size_type n = 0;
+		const_iterator it = position_at_most(count, n);
+		if (n == count) {
+			erase_after(it, cend());
+			return;
+		}
+		if (count - n >= slab_threshold) {
+			insert_slab(it, count - n, [&](value_type* ptr) {
+				Alloc_traits::construct(m_allocator, ptr);
+			});
+			return;
+		}
+		for (; n < count; n++) {
+			it = emplace_after(it);
 		}
 	}
 	
 	void resize(size_type count, const value_type& val) {
-		const_iterator it = begin();
-		for (size_type n = 1; n < count; n++, it++) {
-			if (it.m_node->next == nullptr) {
-				insert_after(it, count-n, val);
-				return;
-			}
+		if (track_size && count == size()) {
+			return;
 		}
-		
-		if (it.m_node->next != nullptr) {
-			erase_after(it, end());
+		size_type n = 0;
+		const_iterator it = position_at_most(count, n);
+		if (n == count) {
+			erase_after(it, cend());
+		} else {
+			insert_after(it, count - n, val);
 		}
 	}
 	
 	void swap(Forward_list& other) {
 		std::swap(m_head, other.m_head);
 		std::swap(m_allocator, other.m_allocator);
+		std::swap(m_slabs, other.m_slabs);
+		this->swap_size(other);
 	}
 	
 	// Operations
 	
 	void merge(Forward_list& other) {
-		const_iterator other_it = other.begin();
-		const_iterator it = before_begin();
-		
-		for (; it.next() != end(); ++it) {
-			if ( *(it.next()) > *other_it ) {
-				insert_after(it, *other_it);
-				if (++other_it == other.end()) {
-					return;
-				}
-			}
-		}
-		
-		insert_after(it, other_it, other.cend());
+		merge(other, std::less<value_type>());
 	}
 	
 	void merge(Forward_list&& other) {
-		const_iterator other_it = other.begin();
-		const_iterator it = before_begin();
-		
-		for (; it.next() != end(); ++it) {
-			if ( *(it.next()) > *other_it ) {
-				insert_after(it, std::move(*other_it));
-				if (++other_it == other.end()) {
-					return;
-				}
-			}
-		}
-		
-		insert_after(it, other_it, other.cend());
+		merge(other, std::less<value_type>());
 	}
 	
+	/**
+	 * moves the nodes of other into this list, both lists must be sorted
+	 * with respect to comp. Equivalent elements of this list come first.
+	 */
 	template <class Compare>
 	void merge(Forward_list& other, Compare comp) {
-		const_iterator other_it = other.begin();
-		const_iterator it = before_begin();
-		
-		for (; it.next() != end(); ++it) {
-			if ( comp( *(it.next()), *other_it ) ) {
-				insert_after(it, *other_it);
-				if (++other_it == other.end()) {
-					return;
-				}
-			}
+		if (this == &other) {
+			return;
 		}
-		
-		insert_after(it, other_it, other.cend());
+		m_head->next = merge_nodes(m_head->next, other.m_head->next, comp);
+		other.m_head->next = nullptr;
+		share_slabs(other);
+		this->add_size(other.stored_size());
+		other.sub_size(other.stored_size());
 	}
 	
 	template <class Compare>
 	void merge(Forward_list&& other, Compare comp) {
-		const_iterator other_it = other.begin();
-		const_iterator it = before_begin();
-		
-		for (; it.next() != end(); ++it) {
-			if ( comp( *(it.next()), *other_it ) ) {
-				insert_after(it, std::move(*other_it));
-				if (++other_it == other.end()) {
-					return;
-				}
-			}
-		}
-		
-		insert_after(it, other_it, other.cend());
+		merge(other, comp);
 	}
 	
-	void splice_after(const_iterator pos, Forward_list& other) {
+	template <class ListIterator>
+	void k_way_merge(ListIterator first, ListIterator last) {
+		k_way_merge(first, last, std::less<value_type>());
+	}
 	
+	/**
+	 * @brief merges every list in [first, last) into this list in one pass
+	 *
+	 * The front nodes of all lists are kept in a binary heap, so each node
+	 * costs O(log k) comparisons instead of the O(k) passes of repeated two
+	 * way merges. Nodes are relinked, not copied, and the source lists are left
+	 * empty. Equivalent elements keep the order of their lists, this list first.
+	 */
+	template <class ListIterator, class Compare>
+	void k_way_merge(ListIterator first, ListIterator last, Compare comp) {
+		merge_lists(first, last, comp, [](const value_type&, const value_type&) { return false; });
 	}
 	
-	void splice_after(const_iterator pos, Forward_list&& other) {
+	template <class ListIterator>
+	size_type k_way_merge_unique(ListIterator first, ListIterator last) {
+		return k_way_merge_unique(first, last, std::less<value_type>(), std::equal_to<value_type>());
+	}
 	
+	/**
+	 * @brief k_way_merge that also drops each element equal to the element
+	 * before it in the merged order, like calling unique afterwards
+	 * @return the number of elements removed
+	 */
+	template <class ListIterator, class Compare, class BinaryPredicate>
+	size_type k_way_merge_unique(ListIterator first, ListIterator last, Compare comp, BinaryPredicate p) {
+		return merge_lists(first, last, comp, p);
 	}
 	
-	void splice_after( const_iterator pos, Forward_list& other, const_iterator it ) {
+	void splice_after(const_iterator pos, Forward_list& other) {
+		splice_after(pos, other, other.cbefore_begin(), other.cend());
+	}
 	
+	void splice_after(const_iterator pos, Forward_list&& other) {
+		splice_after(pos, other);
+	}
+	
+	/**
+	 * @brief moves the element after it into this list after pos
+	 */
+	void splice_after(const_iterator pos, Forward_list& other, const_iterator it) {
+		Node<value_type>* prev = const_cast<Node<value_type>*>(it.m_node);
+		Node<value_type>* node = prev->next;
+		Node<value_type>* dest = const_cast<Node<value_type>*>(pos.m_node);
+		if (node == nullptr || dest == prev || dest == node) {
+			return;
+		}
+		prev->next = node->next;
+		node->next = dest->next;
+		dest->next = node;
+		if (this != &other) {
+			other.sub_size(1);
+			this->add_size(1);
+			share_slab_of(other, node);
+		}
 	}
-                   
-	void splice_after( const_iterator pos, Forward_list&& other, const_iterator it ) {
 	
+	void splice_after(const_iterator pos, Forward_list&& other, const_iterator it) {
+		splice_after(pos, other, it);
 	}
-
-	void splice_after( const_iterator pos, Forward_list& other, const_iterator first, const_iterator last ) {
 	
+	/**
+	 * @brief moves the elements in (first, last) into this list after pos
+	 *
+	 * The range is walked once to find its last node, and with track_size
+	 * the elements are counted on the same walk. Splicing all of other
+	 * takes the count from other.size() instead.
+	 */
+	void splice_after(const_iterator pos, Forward_list& other, const_iterator first, const_iterator last) {
+		Node<value_type>* before_first = const_cast<Node<value_type>*>(first.m_node);
+		Node<value_type>* dest = const_cast<Node<value_type>*>(pos.m_node);
+		if (before_first->next == last.m_node) {
+			return;
+		}
+		
+		const bool whole_list = before_first == other.m_head && last.m_node == nullptr;
+		const bool count_nodes = track_size && this != &other && !whole_list;
+		// a partial splice only shares the slabs holding the moved nodes,
+		// runs of nodes from one slab are looked up once
+		const bool share_nodes = this != &other && !whole_list && !other.m_slabs.empty();
+		const slab* shared = nullptr;
+		size_type count = 1;
+		Node<value_type>* front = before_first->next;
+		Node<value_type>* back = front;
+		for (;; back = back->next) {
+			if (share_nodes && !(shared && slab_holds(*shared, back))) {
+				shared = share_slab_of(other, back);
+			}
+			if (back->next == last.m_node) {
+				break;
+			}
+			if (count_nodes) {
+				++count;
+			}
+		}
+		if (whole_list) {
+			count = other.stored_size();
+		}
+		
+		before_first->next = const_cast<Node<value_type>*>(last.m_node);
+		back->next = dest->next;
+		dest->next = front;
+		
+		if (this != &other) {
+			other.sub_size(count);
+			this->add_size(count);
+			if (whole_list) {
+				share_slabs(other);
+			}
+		}
 	}
-
-	void splice_after( const_iterator pos, Forward_list&& other, const_iterator first, const_iterator last ) {
 	
+	void splice_after(const_iterator pos, Forward_list&& other, const_iterator first, const_iterator last) {
+		splice_after(pos, other, first, last);
 	}
-
+	
 	size_type remove(const value_type& val) {
 		size_type removed_elems = 0;
 		for (const_iterator it = before_begin(); it.m_node->next != nullptr;) {
@@ -685,50 +813,310 @@ public:
 	}
 	
 	void sort() {
-		
+		sort(std::less<value_type>());
 	}
 	
+	/**
+	 * stable merge sort that relinks the existing nodes without allocating
+	 */
 	template <class Compare>
 	void sort(Compare comp) {
-		
+		m_head->next = sort_nodes(m_head->next, comp);
 	}
 
 private:
+	/**
+	 * @brief block of nodes allocated together by a bulk insertion
+	 *
+	 * A list keeps a reference to every slab that may hold one of its nodes.
+	 * Splicing nodes in from another list shares the slabs holding them, and
+	 * merging or splicing a whole list shares all of its slabs, so a slab
+	 * lives until no list can reach its nodes. Erased slab
+	 * nodes are not reused individually; their memory returns when the slab
+	 * is released.
+	 */
+	struct slab {
+		std::shared_ptr<Node<value_type>> nodes;
+		size_type count;
+	};
+	
+	static constexpr size_type slab_threshold = 8;
+	
 	Node<value_type>* m_head;
 	allocator_type m_allocator;
+	std::vector<slab> m_slabs;
+	
+	static bool slab_before(const slab& lhs, const Node<value_type>* node) {
+		return std::less<const Node<value_type>*>()(lhs.nodes.get() + lhs.count - 1, node);
+	}
+	
+	static bool slab_holds(const slab& s, const Node<value_type>* node) {
+		return !std::less<const Node<value_type>*>()(node, s.nodes.get()) && !slab_before(s, node);
+	}
+	
+	/**
+	 * @brief the slab holding node, or nullptr if node was allocated alone
+	 */
+	const slab* slab_of(const Node<value_type>* node) const {
+		if (m_slabs.empty()) {
+			return nullptr;
+		}
+		typename std::vector<slab>::const_iterator it = std::lower_bound(m_slabs.begin(), m_slabs.end(), node, slab_before);
+		return it != m_slabs.end() && slab_holds(*it, node) ? &*it : nullptr;
+	}
+	
+	bool in_slab(const Node<value_type>* node) const {
+		return slab_of(node) != nullptr;
+	}
+	
+	void deallocate_node(Node<value_type>* node) {
+		if (!in_slab(node)) {
+			delete node;
+		}
+	}
+	
+	/**
+	 * @brief adds the slabs of other that this list does not reference yet,
+	 * used when all nodes of other move into this list
+	 */
+	void share_slabs(const Forward_list& other) {
+		for (const slab& other_slab : other.m_slabs) {
+			share_slab(other_slab);
+		}
+	}
+	
+	/**
+	 * @brief references the slab of other holding node, if any, before node
+	 * moves into this list
+	 * @return the slab of other holding node, or nullptr
+	 */
+	const slab* share_slab_of(const Forward_list& other, const Node<value_type>* node) {
+		const slab* other_slab = other.slab_of(node);
+		if (other_slab) {
+			share_slab(*other_slab);
+		}
+		return other_slab;
+	}
+	
+	void share_slab(const slab& other_slab) {
+		typename std::vector<slab>::iterator it =
+			std::lower_bound(m_slabs.begin(), m_slabs.end(), other_slab.nodes.get(), slab_before);
+		if (it == m_slabs.end() || it->nodes != other_slab.nodes) {
+			m_slabs.insert(it, other_slab);
+		}
+	}
+	
+	/**
+	 * @brief constructs count elements in one new slab and links them after pos
+	 * in memory order
+	 * @return an iterator to the last inserted element
+	 */
+	template <class Construct>
+	iterator insert_slab(const_iterator pos, size_type count, Construct construct) {
+		slab new_slab{std::shared_ptr<Node<value_type>>(new Node<value_type>[count], std::default_delete<Node<value_type>[]>()), count};
+		Node<value_type>* nodes = new_slab.nodes.get();
+		
+		size_type built = 0;
+		try {
+			for (; built < count; ++built) {
+				construct(nodes[built].val_ptr());
+			}
+		} catch (...) {
+			while (built > 0) {
+				Alloc_traits::destroy(m_allocator, nodes[--built].val_ptr());
+			}
+			throw;
+		}
+		
+		Node<value_type>* prev = const_cast<Node<value_type>*>(pos.m_node);
+		for (size_type i = 0; i + 1 < count; ++i) {
+			nodes[i].next = &nodes[i + 1];
+		}
+		nodes[count - 1].next = prev->next;
+		prev->next = nodes;
+		
+		m_slabs.insert(std::lower_bound(m_slabs.begin(), m_slabs.end(), nodes, slab_before), new_slab);
+		this->add_size(count);
+		return iterator(&nodes[count - 1]);
+	}
+	
+	template <class InputIterator>
+	iterator insert_range(const_iterator pos, InputIterator first, InputIterator last, std::input_iterator_tag) {
+		iterator list_it(const_cast<Node<value_type>*>(pos.m_node));
+		for (InputIterator it = first; it != last; it++, list_it++) {
+			insert_after(list_it, *it);
+		}
+		return list_it;
+	}
+	
+	/**
+	 * @brief with a known length, large ranges go into a single slab
+	 */
+	template <class ForwardIterator>
+	iterator insert_range(const_iterator pos, ForwardIterator first, ForwardIterator last, std::forward_iterator_tag) {
+		const size_type count = std::distance(first, last);
+		if (count < slab_threshold) {
+			return insert_range(pos, first, last, std::input_iterator_tag());
+		}
+		return insert_slab(pos, count, [&](value_type* ptr) {
+			Alloc_traits::construct(m_allocator, ptr, *first);
+			++first;
+		});
+	}
+	
+	/**
+	 * @brief walks at most count nodes past before_begin
+	 * @return the last node reached, steps is set to the number walked
+	 */
+	const_iterator position_at_most(size_type count, size_type& steps) const {
+		const Node<value_type>* node = m_head;
+		for (steps = 0; steps < count && node->next != nullptr; ++steps) {
+			node = node->next;
+		}
+		return const_iterator(node);
+	}
+	
+	/**
+	 * @brief heap of list fronts, ordered by value and then by list index
+	 */
+	struct merge_source {
+		Node<value_type>* node;
+		size_type list;
+	};
+	
+	template <class Compare>
+	static bool merge_before(const merge_source& lhs, const merge_source& rhs, Compare& comp) {
+		if (comp(*(lhs.node->val_ptr()), *(rhs.node->val_ptr()))) {
+			return true;
+		}
+		return !comp(*(rhs.node->val_ptr()), *(lhs.node->val_ptr())) && lhs.list < rhs.list;
+	}
+	
+	template <class Compare>
+	static void sift_down(std::vector<merge_source>& heap, size_type index, Compare& comp) {
+		const merge_source source = heap[index];
+		for (size_type child; (child = 2*index + 1) < heap.size(); index = child) {
+			if (child + 1 < heap.size() && merge_before(heap[child + 1], heap[child], comp)) {
+				++child;
+			}
+			if (!merge_before(heap[child], source, comp)) {
+				break;
+			}
+			heap[index] = heap[child];
+		}
+		heap[index] = source;
+	}
+	
+	template <class ListIterator, class Compare, class BinaryPredicate>
+	size_type merge_lists(ListIterator first, ListIterator last, Compare& comp, BinaryPredicate p) {
+		std::vector<merge_source> heap;
+		if (m_head->next != nullptr) {
+			heap.push_back(merge_source{m_head->next, 0});
+		}
+		for (size_type list = 1; first != last; ++first, ++list) {
+			Forward_list& other = *first;
+			if (&other == this || other.m_head->next == nullptr) {
+				continue;
+			}
+			heap.push_back(merge_source{other.m_head->next, list});
+			other.m_head->next = nullptr;
+			share_slabs(other);
+			this->add_size(other.stored_size());
+			other.sub_size(other.stored_size());
+		}
+		for (size_type index = heap.size() / 2; index-- > 0;) {
+			sift_down(heap, index, comp);
+		}
+		
+		size_type removed_elems = 0;
+		Node<value_type>* tail = m_head;
+		while (!heap.empty()) {
+			Node<value_type>* node = heap.front().node;
+			if (node->next != nullptr) {
+				heap.front().node = node->next;
+			} else {
+				heap.front() = heap.back();
+				heap.pop_back();
+			}
+			if (!heap.empty()) {
+				sift_down(heap, 0, comp);
+			}
+			
+			if (tail != m_head && p(*(node->val_ptr()), *(tail->val_ptr()))) {
+				Alloc_traits::destroy(m_allocator, node->val_ptr());
+				deallocate_node(node);
+				++removed_elems;
+			} else {
+				tail->next = node;
+				tail = node;
+			}
+		}
+		tail->next = nullptr;
+		this->sub_size(removed_elems);
+		return removed_elems;
+	}
+	
+	template <class Compare>
+	static Node<value_type>* merge_nodes(Node<value_type>* first, Node<value_type>* second, Compare& comp) {
+		auto less = node_less(comp);
+		return ds::detail::merge_chains(first, second, less);
+	}
+	
+	template <class Compare>
+	static Node<value_type>* sort_nodes(Node<value_type>* head, Compare& comp) {
+		auto less = node_less(comp);
+		return ds::detail::sort_chain(head, less);
+	}
+	
+	template <class Compare>
+	static auto node_less(Compare& comp) {
+		return [&comp](Node<value_type>* lhs, Node<value_type>* rhs) { return comp(*(lhs->val_ptr()), *(rhs->val_ptr())); };
+	}
 };
 
-template< class T, class Alloc >
-bool operator==( const Forward_list<T,Alloc>& lhs, const Forward_list<T,Alloc>& rhs ) {
-
+template< class T, class Alloc, bool track_size >
+bool operator==( const Forward_list<T,Alloc,track_size>& lhs, const Forward_list<T,Alloc,track_size>& rhs ) {
+	if constexpr (track_size) {
+		if (lhs.size() != rhs.size()) {
+			return false;
+		}
+	}
+	auto l = lhs.cbegin();
+	auto r = rhs.cbegin();
+	for (; l != lhs.cend() && r != rhs.cend(); ++l, ++r) {
+		if (!(*l == *r)) {
+			return false;
+		}
+	}
+	return l == lhs.cend() && r == rhs.cend();
 }
                  
-template< class T, class Alloc >
-bool operator!=( const Forward_list<T,Alloc>& lhs, const Forward_list<T,Alloc>& rhs ) {
-
+template< class T, class Alloc, bool track_size >
+bool operator!=( const Forward_list<T,Alloc,track_size>& lhs, const Forward_list<T,Alloc,track_size>& rhs ) {
+	return !(lhs == rhs);
 }
                  
-template< class T, class Alloc >
-bool operator<( const Forward_list<T,Alloc>& lhs, const Forward_list<T,Alloc>& rhs ) {
-
+template< class T, class Alloc, bool track_size >
+bool operator<( const Forward_list<T,Alloc,track_size>& lhs, const Forward_list<T,Alloc,track_size>& rhs ) {
+	return std::lexicographical_compare(lhs.cbegin(), lhs.cend(), rhs.cbegin(), rhs.cend());
 }
                 
-template< class T, class Alloc >
-bool operator<=( const Forward_list<T,Alloc>& lhs, const Forward_list<T,Alloc>& rhs ) {
-
+template< class T, class Alloc, bool track_size >
+bool operator<=( const Forward_list<T,Alloc,track_size>& lhs, const Forward_list<T,Alloc,track_size>& rhs ) {
+	return !(rhs < lhs);
 }
                  
-template< class T, class Alloc >
-bool operator>( const Forward_list<T,Alloc>& lhs, const Forward_list<T,Alloc>& rhs ) {
-
+template< class T, class Alloc, bool track_size >
+bool operator>( const Forward_list<T,Alloc,track_size>& lhs, const Forward_list<T,Alloc,track_size>& rhs ) {
+	return rhs < lhs;
 }
                 
-template< class T, class Alloc >
-bool operator>=( const Forward_list<T,Alloc>& lhs, const Forward_list<T,Alloc>& rhs ) {
-
+template< class T, class Alloc, bool track_size >
+bool operator>=( const Forward_list<T,Alloc,track_size>& lhs, const Forward_list<T,Alloc,track_size>& rhs ) {
+	return !(lhs < rhs);
 }
 
-template< class T, class Alloc >
-void swap( Forward_list<T,Alloc>& lhs, Forward_list<T,Alloc>& rhs ) {
-
+template< class T, class Alloc, bool track_size >
+void swap( Forward_list<T,Alloc,track_size>& lhs, Forward_list<T,Alloc,track_size>& rhs ) {
+	lhs.swap(rhs);
 }
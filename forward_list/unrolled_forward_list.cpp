@@ -0,0 +1,404 @@
+/**
+ * Unrolled forward list
+ *
+ * Singly linked list that stores up to node_capacity elements in each cache
+ * line aligned node. Inserting into a full node splits it in half and erasing
+ * from a node that drops below half full pulls in the elements of the next
+ * node, so iteration walks mostly contiguous memory.
+ */
+#include <stddef.h>
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace ds {
+
+	template <typename T, size_t node_bytes>
+	struct alignas(64) unrolled_node {
+		static constexpr size_t capacity =
+			std::max<size_t>(2, (node_bytes - sizeof(void*) - sizeof(size_t))/sizeof(T));
+
+		T* val_ptr(size_t index) { return reinterpret_cast<T*>(&values[index]); }
+
+		const T* val_ptr(size_t index) const { return reinterpret_cast<const T*>(&values[index]); }
+
+		unrolled_node* next = nullptr;
+		size_t count = 0;
+		typename std::aligned_storage<sizeof(T), alignof(T)>::type values[capacity];
+	};
+
+	template <typename T, typename Allocator = std::allocator<T>, size_t node_bytes = 64>
+	class unrolled_forward_list {
+
+		typedef std::allocator_traits<Allocator> Alloc_traits;
+		typedef unrolled_node<T, node_bytes> node_type;
+
+	public:
+		typedef T value_type;
+		typedef Allocator allocator_type;
+		typedef size_t size_type;
+		typedef ptrdiff_t difference_type;
+		typedef value_type& reference;
+		typedef const value_type& const_reference;
+		typedef typename Alloc_traits::pointer pointer;
+		typedef typename Alloc_traits::const_pointer const_pointer;
+
+		static constexpr size_type node_capacity = node_type::capacity;
+
+		/**
+		 * Iterators hold a node and an index into it. Inserting or erasing
+		 * invalidates iterators to elements after the modified position.
+		 */
+		template <bool is_const>
+		class basic_iterator {
+		public:
+			typedef std::forward_iterator_tag iterator_category;
+			typedef T value_type;
+			typedef ptrdiff_t difference_type;
+			typedef typename std::conditional<is_const, const T*, T*>::type pointer;
+			typedef typename std::conditional<is_const, const T&, T&>::type reference;
+			typedef typename std::conditional<is_const, const node_type*, node_type*>::type node_pointer;
+
+			basic_iterator() : m_node(), m_index() {}
+
+			basic_iterator(node_pointer node, size_t index) : m_node(node), m_index(index) {}
+
+			template <bool other_const, class = typename std::enable_if<is_const && !other_const>::type>
+			basic_iterator(const basic_iterator<other_const>& other) : m_node(other.m_node), m_index(other.m_index) {}
+
+			reference operator*() const { return *m_node->val_ptr(m_index); }
+
+			pointer operator->() const { return m_node->val_ptr(m_index); }
+
+			basic_iterator& operator++() {
+				if (++m_index >= m_node->count) {
+					m_node = m_node->next;
+					m_index = 0;
+				}
+				return *this;
+			}
+
+			basic_iterator operator++(int) {
+				basic_iterator tmp(*this);
+				++*this;
+				return tmp;
+			}
+
+			bool operator==(const basic_iterator& rhs) const { return m_node == rhs.m_node && m_index == rhs.m_index; }
+
+			bool operator!=(const basic_iterator& rhs) const { return !(*this == rhs); }
+
+		private:
+			friend class unrolled_forward_list;
+
+			node_pointer m_node;
+			size_t m_index;
+		};
+
+		typedef basic_iterator<false> iterator;
+		typedef basic_iterator<true> const_iterator;
+
+		// Constructors, Destructors and Assignment
+
+		unrolled_forward_list() : m_head(new node_type()), m_size(), m_allocator() {}
+
+		explicit unrolled_forward_list(const allocator_type& alloc) : m_head(new node_type()), m_size(), m_allocator(alloc) {}
+
+		unrolled_forward_list(size_type count, const value_type& val, const allocator_type& alloc = allocator_type())
+			: unrolled_forward_list(alloc) {
+			insert_after(before_begin(), count, val);
+		}
+
+		template <class InputIterator, class = typename std::iterator_traits<InputIterator>::iterator_category>
+		unrolled_forward_list(InputIterator first, InputIterator last, const allocator_type& alloc = allocator_type())
+			: unrolled_forward_list(alloc) {
+			insert_after(before_begin(), first, last);
+		}
+
+		unrolled_forward_list(std::initializer_list<value_type> il, const allocator_type& alloc = allocator_type())
+			: unrolled_forward_list(il.begin(), il.end(), alloc) {}
+
+		unrolled_forward_list(const unrolled_forward_list& other)
+			: unrolled_forward_list(other.begin(), other.end(), other.m_allocator) {}
+
+		unrolled_forward_list(unrolled_forward_list&& other) : unrolled_forward_list(other.m_allocator) {
+			this->swap(other);
+		}
+
+		~unrolled_forward_list() {
+			clear();
+			delete m_head;
+		}
+
+		unrolled_forward_list& operator=(const unrolled_forward_list& other) {
+			if (this != &other) {
+				clear();
+				insert_after(before_begin(), other.begin(), other.end());
+			}
+			return *this;
+		}
+
+		unrolled_forward_list& operator=(unrolled_forward_list&& other) {
+			this->swap(other);
+			return *this;
+		}
+
+		unrolled_forward_list& operator=(std::initializer_list<value_type> il) {
+			clear();
+			insert_after(before_begin(), il.begin(), il.end());
+			return *this;
+		}
+
+		allocator_type get_allocator() const { return m_allocator; }
+
+		// Element access
+
+		reference front() { return *m_head->next->val_ptr(0); }
+
+		const_reference front() const { return *m_head->next->val_ptr(0); }
+
+		// Iterators
+
+		iterator before_begin() { return iterator(m_head, 0); }
+
+		const_iterator before_begin() const { return const_iterator(m_head, 0); }
+
+		const_iterator cbefore_begin() const { return const_iterator(m_head, 0); }
+
+		iterator begin() { return iterator(m_head->next, 0); }
+
+		const_iterator begin() const { return const_iterator(m_head->next, 0); }
+
+		const_iterator cbegin() const { return const_iterator(m_head->next, 0); }
+
+		iterator end() { return iterator(); }
+
+		const_iterator end() const { return const_iterator(); }
+
+		const_iterator cend() const { return const_iterator(); }
+
+		// Capacity
+
+		bool empty() const { return m_size == 0; }
+
+		size_type size() const { return m_size; }
+
+		size_type max_size() const { return Alloc_traits::max_size(m_allocator); }
+
+		// Modifiers
+
+		void clear() {
+			for (node_type* node = m_head->next; node;) {
+				node_type* next = node->next;
+				for (size_t i = 0; i < node->count; ++i)
+					Alloc_traits::destroy(m_allocator, node->val_ptr(i));
+				delete node;
+				node = next;
+			}
+			m_head->next = nullptr;
+			m_size = 0;
+		}
+
+		iterator insert_after(const_iterator pos, const value_type& val) { return emplace_after(pos, val); }
+
+		iterator insert_after(const_iterator pos, value_type&& val) { return emplace_after(pos, std::move(val)); }
+
+		iterator insert_after(const_iterator pos, size_type count, const value_type& val) {
+			iterator it = to_mutable(pos);
+			for (size_type n = 0; n < count; ++n)
+				it = emplace_after(it, val);
+			return it;
+		}
+
+		template <class InputIterator, class = typename std::iterator_traits<InputIterator>::iterator_category>
+		iterator insert_after(const_iterator pos, InputIterator first, InputIterator last) {
+			iterator it = to_mutable(pos);
+			for (; first != last; ++first)
+				it = emplace_after(it, *first);
+			return it;
+		}
+
+		iterator insert_after(const_iterator pos, std::initializer_list<value_type> il) {
+			return insert_after(pos, il.begin(), il.end());
+		}
+
+		/**
+		 * @brief constructs an element after pos
+		 *
+		 * Full nodes are split in half, except when appending to the end of a
+		 * node, where a fresh node is started so sequential inserts fill nodes.
+		 * The element is constructed before any element moves, so a throwing
+		 * constructor leaves the list unchanged and args may refer to an
+		 * element of the list.
+		 */
+		template <class... Args>
+		iterator emplace_after(const_iterator pos, Args&&... args) {
+			value_type val(std::forward<Args>(args)...);
+			node_type* node = const_cast<node_type*>(pos.m_node);
+			size_t index = pos.m_index + 1;
+
+			if (node == m_head) {
+				node = m_head->next;
+				index = 0;
+				if (!node || node->count == node_capacity)
+					node = insert_node(m_head);
+			} else if (node->count == node_capacity) {
+				if (index == node_capacity) {
+					node = insert_node(node);
+					index = 0;
+				} else {
+					node_type* next = insert_node(node);
+					const size_t half = node_capacity/2;
+					move_elements(node, half, node_capacity, next, 0);
+					next->count = node_capacity - half;
+					node->count = half;
+					if (index > half) {
+						node = next;
+						index -= half;
+					}
+				}
+			}
+
+			for (size_t i = node->count; i > index; --i)
+				move_element(node, i-1, node, i);
+			Alloc_traits::construct(m_allocator, node->val_ptr(index), std::move(val));
+			++node->count;
+			++m_size;
+			return iterator(node, index);
+		}
+
+		/**
+		 * @brief removes the element after pos
+		 *
+		 * A node left at most half full takes in the elements of the next node
+		 * when they fit.
+		 */
+		iterator erase_after(const_iterator pos) {
+			node_type* prev = nullptr;
+			node_type* node = const_cast<node_type*>(pos.m_node);
+			size_t index = pos.m_index + 1;
+			if (node == m_head || index >= node->count) {
+				prev = node;
+				node = node->next;
+				index = 0;
+			}
+			if (!node) return end();
+
+			Alloc_traits::destroy(m_allocator, node->val_ptr(index));
+			for (size_t i = index + 1; i < node->count; ++i)
+				move_element(node, i, node, i-1);
+			--node->count;
+			--m_size;
+
+			if (node->count == 0) {
+				prev->next = node->next;
+				delete node;
+				return iterator(prev->next, 0);
+			}
+
+			node_type* next = node->next;
+			if (next && node->count <= node_capacity/2 && node->count + next->count <= node_capacity) {
+				move_elements(next, 0, next->count, node, node->count);
+				node->count += next->count;
+				node->next = next->next;
+				delete next;
+			}
+
+			if (index < node->count) return iterator(node, index);
+			return iterator(node->next, 0);
+		}
+
+		iterator erase_after(const_iterator first, const_iterator last) {
+			const_iterator next = first;
+			difference_type count = std::distance(++next, last);
+			for (; count > 0; --count)
+				erase_after(first);
+			return to_mutable(++first);
+		}
+
+		void push_front(const value_type& val) { emplace_after(before_begin(), val); }
+
+		void push_front(value_type&& val) { emplace_after(before_begin(), std::move(val)); }
+
+		template <class... Args>
+		reference emplace_front(Args&&... args) {
+			return *emplace_after(before_begin(), std::forward<Args>(args)...);
+		}
+
+		void pop_front() {
+			if (!empty()) erase_after(before_begin());
+		}
+
+		void swap(unrolled_forward_list& other) {
+			std::swap(m_head, other.m_head);
+			std::swap(m_size, other.m_size);
+			std::swap(m_allocator, other.m_allocator);
+		}
+
+		// Operations
+
+		size_type remove(const value_type& val) {
+			return remove_if([&val](const value_type& elem) { return elem == val; });
+		}
+
+		template <class UnaryPredicate>
+		size_type remove_if(UnaryPredicate p) {
+			size_type removed_elems = 0;
+			for (iterator it = before_begin(), next = begin(); next != end();) {
+				if (p(*next)) {
+					next = erase_after(it);
+					++removed_elems;
+				} else {
+					it = next++;
+				}
+			}
+			return removed_elems;
+		}
+
+	private:
+		node_type* m_head;
+		size_type m_size;
+		allocator_type m_allocator;
+
+		static iterator to_mutable(const_iterator it) {
+			return iterator(const_cast<node_type*>(it.m_node), it.m_index);
+		}
+
+		node_type* insert_node(node_type* prev) {
+			node_type* node = new node_type();
+			node->next = prev->next;
+			prev->next = node;
+			return node;
+		}
+
+		void move_element(node_type* from, size_t from_index, node_type* to, size_t to_index) {
+			Alloc_traits::construct(m_allocator, to->val_ptr(to_index), std::move(*from->val_ptr(from_index)));
+			Alloc_traits::destroy(m_allocator, from->val_ptr(from_index));
+		}
+
+		void move_elements(node_type* from, size_t first, size_t last, node_type* to, size_t to_index) {
+			for (size_t i = first; i < last; ++i, ++to_index)
+				move_element(from, i, to, to_index);
+		}
+	};
+
+	template <typename T, typename Alloc, size_t node_bytes>
+	bool operator==(const unrolled_forward_list<T, Alloc, node_bytes>& lhs, const unrolled_forward_list<T, Alloc, node_bytes>& rhs) {
+		return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+	}
+
+	template <typename T, typename Alloc, size_t node_bytes>
+	bool operator!=(const unrolled_forward_list<T, Alloc, node_bytes>& lhs, const unrolled_forward_list<T, Alloc, node_bytes>& rhs) {
+		return !(lhs == rhs);
+	}
+}
+
+namespace std {
+	template <typename T, typename Alloc, size_t node_bytes>
+	void swap(ds::unrolled_forward_list<T, Alloc, node_bytes>& lhs, ds::unrolled_forward_list<T, Alloc, node_bytes>& rhs) {
+		lhs.swap(rhs);
+	}
+}
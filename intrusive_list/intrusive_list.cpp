@@ -0,0 +1,690 @@
+/**
+ * Intrusive linked lists
+ *
+ * The lists link objects owned by the caller through a hook member instead of
+ * allocating nodes, so inserting and erasing never allocate. An object can be
+ * in as many lists at once as it has hooks. The lists never destroy the
+ * objects, erasing only unlinks them.
+ *
+ *   struct timer {
+ *       ds::intrusive_list_hook hook;
+ *       ...
+ *   };
+ *   ds::intrusive_list<timer, offsetof(timer, hook)> timers;
+ *
+ * The hook is named by its offset, so T must be a standard layout type.
+ */
+#include "../forward_list/chain_sort.cpp"
+
+#include <stddef.h>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace ds {
+
+	struct intrusive_forward_list_hook {
+		intrusive_forward_list_hook* next = nullptr;
+	};
+
+	struct intrusive_list_hook {
+		intrusive_list_hook* next = nullptr;
+		intrusive_list_hook* previous = nullptr;
+
+		bool is_linked() const { return next; }
+	};
+
+	/**
+	 * returns the object that owns the hook at offset bytes into it
+	 */
+	template <typename T, typename Hook, size_t offset>
+	T* hook_owner(Hook* hook) {
+		return reinterpret_cast<T*>(reinterpret_cast<unsigned char*>(hook) - offset);
+	}
+
+	/**
+	 * returns the hook at offset bytes into value
+	 */
+	template <typename Hook, size_t offset, typename T>
+	Hook* owned_hook(T& value) {
+		return reinterpret_cast<Hook*>(reinterpret_cast<unsigned char*>(std::addressof(value)) + offset);
+	}
+
+	template <typename T, size_t Hook>
+	class intrusive_forward_list {
+		typedef intrusive_forward_list_hook hook_type;
+
+		static_assert(std::is_standard_layout<T>::value, "ds::intrusive_forward_list: T must be standard layout for offsetof");
+
+	public:
+		typedef T value_type;
+		typedef size_t size_type;
+		typedef ptrdiff_t difference_type;
+		typedef T& reference;
+		typedef const T& const_reference;
+		typedef T* pointer;
+		typedef const T* const_pointer;
+
+		template <bool is_const>
+		class basic_iterator {
+		public:
+			typedef std::forward_iterator_tag iterator_category;
+			typedef T value_type;
+			typedef ptrdiff_t difference_type;
+			typedef typename std::conditional<is_const, const T*, T*>::type pointer;
+			typedef typename std::conditional<is_const, const T&, T&>::type reference;
+
+			basic_iterator() : m_hook() {}
+
+			explicit basic_iterator(hook_type* hook) : m_hook(hook) {}
+
+			template <bool other_const, class = typename std::enable_if<is_const && !other_const>::type>
+			basic_iterator(const basic_iterator<other_const>& other) : m_hook(other.m_hook) {}
+
+			reference operator*() const { return *hook_owner<T, hook_type, Hook>(m_hook); }
+
+			pointer operator->() const { return hook_owner<T, hook_type, Hook>(m_hook); }
+
+			basic_iterator& operator++() {
+				m_hook = m_hook->next;
+				return *this;
+			}
+
+			basic_iterator operator++(int) {
+				basic_iterator tmp(*this);
+				m_hook = m_hook->next;
+				return tmp;
+			}
+
+			bool operator==(const basic_iterator& rhs) const { return m_hook == rhs.m_hook; }
+
+			bool operator!=(const basic_iterator& rhs) const { return m_hook != rhs.m_hook; }
+
+		private:
+			friend class intrusive_forward_list;
+
+			hook_type* m_hook;
+		};
+
+		typedef basic_iterator<false> iterator;
+		typedef basic_iterator<true> const_iterator;
+
+		// Constructors, Destructors and Assignment
+
+		intrusive_forward_list() = default;
+
+		intrusive_forward_list(const intrusive_forward_list&) = delete;
+
+		intrusive_forward_list(intrusive_forward_list&& other) { this->swap(other); }
+
+		intrusive_forward_list& operator=(const intrusive_forward_list&) = delete;
+
+		intrusive_forward_list& operator=(intrusive_forward_list&& other) {
+			this->swap(other);
+			return *this;
+		}
+
+		~intrusive_forward_list() { clear(); }
+
+		// Element access
+
+		reference front() { return *begin(); }
+
+		const_reference front() const { return *begin(); }
+
+		// Iterators
+
+		iterator before_begin() { return iterator(&m_head); }
+
+		const_iterator before_begin() const { return const_iterator(const_cast<hook_type*>(&m_head)); }
+
+		const_iterator cbefore_begin() const { return before_begin(); }
+
+		iterator begin() { return iterator(m_head.next); }
+
+		const_iterator begin() const { return const_iterator(m_head.next); }
+
+		const_iterator cbegin() const { return begin(); }
+
+		iterator end() { return iterator(); }
+
+		const_iterator end() const { return const_iterator(); }
+
+		const_iterator cend() const { return const_iterator(); }
+
+		/**
+		 * returns an iterator to an object that is linked into the list
+		 */
+		static iterator iterator_to(reference value) { return iterator(owned_hook<hook_type, Hook>(value)); }
+
+		static const_iterator iterator_to(const_reference value) {
+			return const_iterator(owned_hook<hook_type, Hook>(const_cast<reference>(value)));
+		}
+
+		// Capacity
+
+		bool empty() const { return !m_head.next; }
+
+		// Modifiers
+
+		/**
+		 * unlinks every object
+		 */
+		void clear() {
+			for (hook_type* hook = m_head.next; hook;) {
+				hook_type* next = hook->next;
+				hook->next = nullptr;
+				hook = next;
+			}
+			m_head.next = nullptr;
+		}
+
+		iterator insert_after(const_iterator pos, reference value) {
+			hook_type* hook = owned_hook<hook_type, Hook>(value);
+			hook->next = pos.m_hook->next;
+			pos.m_hook->next = hook;
+			return iterator(hook);
+		}
+
+		iterator erase_after(const_iterator pos) {
+			hook_type* hook = pos.m_hook->next;
+			if (hook) {
+				pos.m_hook->next = hook->next;
+				hook->next = nullptr;
+			}
+			return iterator(pos.m_hook->next);
+		}
+
+		iterator erase_after(const_iterator first, const_iterator last) {
+			while (first.m_hook->next != last.m_hook)
+				erase_after(first);
+			return iterator(last.m_hook);
+		}
+
+		void push_front(reference value) { insert_after(before_begin(), value); }
+
+		void pop_front() { erase_after(before_begin()); }
+
+		void swap(intrusive_forward_list& other) { std::swap(m_head.next, other.m_head.next); }
+
+		// Operations
+
+		void merge(intrusive_forward_list& other) { merge(other, std::less<value_type>()); }
+
+		/**
+		 * links the objects of other into this list, both lists must be sorted
+		 * with respect to comp
+		 */
+		template <class Compare>
+		void merge(intrusive_forward_list& other, Compare comp) {
+			if (this == &other) return;
+			m_head.next = merge_hooks(m_head.next, other.m_head.next, comp);
+			other.m_head.next = nullptr;
+		}
+
+		void splice_after(const_iterator pos, intrusive_forward_list& other) {
+			splice_after(pos, other, other.before_begin(), other.end());
+		}
+
+		void splice_after(const_iterator pos, intrusive_forward_list&, const_iterator it) {
+			hook_type* hook = it.m_hook->next;
+			if (!hook || pos.m_hook == it.m_hook || pos.m_hook == hook) return;
+			it.m_hook->next = hook->next;
+			hook->next = pos.m_hook->next;
+			pos.m_hook->next = hook;
+		}
+
+		/**
+		 * moves the objects in (first, last) after pos
+		 */
+		void splice_after(const_iterator pos, intrusive_forward_list&, const_iterator first, const_iterator last) {
+			hook_type* begin = first.m_hook->next;
+			if (begin == last.m_hook) return;
+			hook_type* back = begin;
+			while (back->next != last.m_hook)
+				back = back->next;
+			first.m_hook->next = last.m_hook;
+			back->next = pos.m_hook->next;
+			pos.m_hook->next = begin;
+		}
+
+		size_type remove(const value_type& val) {
+			return remove_if([&val](const value_type& elem) { return elem == val; });
+		}
+
+		template <class UnaryPredicate>
+		size_type remove_if(UnaryPredicate p) {
+			size_type removed_elems = 0;
+			for (hook_type* prev = &m_head; prev->next;) {
+				if (p(*hook_owner<T, hook_type, Hook>(prev->next))) {
+					erase_after(const_iterator(prev));
+					++removed_elems;
+				} else {
+					prev = prev->next;
+				}
+			}
+			return removed_elems;
+		}
+
+		size_type unique() { return unique(std::equal_to<value_type>()); }
+
+		template <class BinaryPredicate>
+		size_type unique(BinaryPredicate p) {
+			size_type removed_elems = 0;
+			for (hook_type* prev = m_head.next; prev && prev->next;) {
+				if (p(*hook_owner<T, hook_type, Hook>(prev->next), *hook_owner<T, hook_type, Hook>(prev))) {
+					erase_after(const_iterator(prev));
+					++removed_elems;
+				} else {
+					prev = prev->next;
+				}
+			}
+			return removed_elems;
+		}
+
+		void reverse() {
+			hook_type* prev = nullptr;
+			for (hook_type* hook = m_head.next; hook;) {
+				hook_type* next = hook->next;
+				hook->next = prev;
+				prev = hook;
+				hook = next;
+			}
+			m_head.next = prev;
+		}
+
+		void sort() { sort(std::less<value_type>()); }
+
+		/**
+		 * stable natural merge sort, see Forward_list::sort
+		 */
+		template <class Compare>
+		void sort(Compare comp) { m_head.next = sort_hooks(m_head.next, comp); }
+
+	private:
+		hook_type m_head;
+
+		template <class Compare>
+		static auto hook_less(Compare& comp) {
+			return [&comp](hook_type* lhs, hook_type* rhs) {
+				return comp(*hook_owner<T, hook_type, Hook>(lhs), *hook_owner<T, hook_type, Hook>(rhs));
+			};
+		}
+
+		template <class Compare>
+		static hook_type* merge_hooks(hook_type* first, hook_type* second, Compare& comp) {
+			auto less = hook_less(comp);
+			return detail::merge_chains(first, second, less);
+		}
+
+		template <class Compare>
+		static hook_type* sort_hooks(hook_type* head, Compare& comp) {
+			auto less = hook_less(comp);
+			return detail::sort_chain(head, less);
+		}
+	};
+
+	/**
+	 * Circular doubly linked intrusive list. The sentinel hook is part of the
+	 * list object, so an empty list owns no memory at all.
+	 */
+	template <typename T, size_t Hook>
+	class intrusive_list {
+		typedef intrusive_list_hook hook_type;
+
+		static_assert(std::is_standard_layout<T>::value, "ds::intrusive_list: T must be standard layout for offsetof");
+
+	public:
+		typedef T value_type;
+		typedef size_t size_type;
+		typedef ptrdiff_t difference_type;
+		typedef T& reference;
+		typedef const T& const_reference;
+		typedef T* pointer;
+		typedef const T* const_pointer;
+
+		template <bool is_const>
+		class basic_iterator {
+		public:
+			typedef std::bidirectional_iterator_tag iterator_category;
+			typedef T value_type;
+			typedef ptrdiff_t difference_type;
+			typedef typename std::conditional<is_const, const T*, T*>::type pointer;
+			typedef typename std::conditional<is_const, const T&, T&>::type reference;
+
+			basic_iterator() : m_hook() {}
+
+			explicit basic_iterator(hook_type* hook) : m_hook(hook) {}
+
+			template <bool other_const, class = typename std::enable_if<is_const && !other_const>::type>
+			basic_iterator(const basic_iterator<other_const>& other) : m_hook(other.m_hook) {}
+
+			reference operator*() const { return *hook_owner<T, hook_type, Hook>(m_hook); }
+
+			pointer operator->() const { return hook_owner<T, hook_type, Hook>(m_hook); }
+
+			basic_iterator& operator++() {
+				m_hook = m_hook->next;
+				return *this;
+			}
+
+			basic_iterator operator++(int) {
+				basic_iterator tmp(*this);
+				m_hook = m_hook->next;
+				return tmp;
+			}
+
+			basic_iterator& operator--() {
+				m_hook = m_hook->previous;
+				return *this;
+			}
+
+			basic_iterator operator--(int) {
+				basic_iterator tmp(*this);
+				m_hook = m_hook->previous;
+				return tmp;
+			}
+
+			bool operator==(const basic_iterator& rhs) const { return m_hook == rhs.m_hook; }
+
+			bool operator!=(const basic_iterator& rhs) const { return m_hook != rhs.m_hook; }
+
+		private:
+			friend class intrusive_list;
+
+			hook_type* m_hook;
+		};
+
+		typedef basic_iterator<false> iterator;
+		typedef basic_iterator<true> const_iterator;
+		typedef std::reverse_iterator<iterator> reverse_iterator;
+		typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+		// Constructors, Destructors and Assignment
+
+		intrusive_list() : m_size() { m_end.next = m_end.previous = &m_end; }
+
+		intrusive_list(const intrusive_list&) = delete;
+
+		intrusive_list(intrusive_list&& other) : intrusive_list() { splice(end(), other); }
+
+		intrusive_list& operator=(const intrusive_list&) = delete;
+
+		intrusive_list& operator=(intrusive_list&& other) {
+			clear();
+			splice(end(), other);
+			return *this;
+		}
+
+		~intrusive_list() { clear(); }
+
+		// Element access
+
+		reference front() { return *begin(); }
+
+		const_reference front() const { return *begin(); }
+
+		reference back() { return *--end(); }
+
+		const_reference back() const { return *--end(); }
+
+		// Iterators
+
+		iterator begin() { return iterator(m_end.next); }
+
+		const_iterator begin() const { return const_iterator(m_end.next); }
+
+		const_iterator cbegin() const { return begin(); }
+
+		iterator end() { return iterator(&m_end); }
+
+		const_iterator end() const { return const_iterator(const_cast<hook_type*>(&m_end)); }
+
+		const_iterator cend() const { return end(); }
+
+		reverse_iterator rbegin() { return reverse_iterator(end()); }
+
+		const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+
+		reverse_iterator rend() { return reverse_iterator(begin()); }
+
+		const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+		/**
+		 * returns an iterator to an object that is linked into the list
+		 */
+		static iterator iterator_to(reference value) { return iterator(owned_hook<hook_type, Hook>(value)); }
+
+		static const_iterator iterator_to(const_reference value) {
+			return const_iterator(owned_hook<hook_type, Hook>(const_cast<reference>(value)));
+		}
+
+		// Capacity
+
+		bool empty() const { return m_size == 0; }
+
+		size_type size() const { return m_size; }
+
+		// Modifiers
+
+		/**
+		 * unlinks every object
+		 */
+		void clear() {
+			for (hook_type* hook = m_end.next; hook != &m_end;) {
+				hook_type* next = hook->next;
+				hook->next = hook->previous = nullptr;
+				hook = next;
+			}
+			m_end.next = m_end.previous = &m_end;
+			m_size = 0;
+		}
+
+		iterator insert(const_iterator pos, reference value) {
+			hook_type* hook = owned_hook<hook_type, Hook>(value);
+			link_before(pos.m_hook, hook, hook);
+			++m_size;
+			return iterator(hook);
+		}
+
+		iterator erase(const_iterator pos) {
+			hook_type* hook = pos.m_hook;
+			hook_type* next = hook->next;
+			unlink(hook, hook);
+			hook->next = hook->previous = nullptr;
+			--m_size;
+			return iterator(next);
+		}
+
+		iterator erase(const_iterator first, const_iterator last) {
+			while (first != last)
+				first = erase(first);
+			return iterator(last.m_hook);
+		}
+
+		void push_back(reference value) { insert(end(), value); }
+
+		void pop_back() { erase(--end()); }
+
+		void push_front(reference value) { insert(begin(), value); }
+
+		void pop_front() { erase(begin()); }
+
+		void swap(intrusive_list& other) {
+			intrusive_list tmp(std::move(other));
+			other.splice(other.end(), *this);
+			splice(end(), tmp);
+		}
+
+		// Operations
+
+		void merge(intrusive_list& other) { merge(other, std::less<value_type>()); }
+
+		/**
+		 * links the objects of other into this list, both lists must be sorted
+		 * with respect to comp
+		 */
+		template <class Compare>
+		void merge(intrusive_list& other, Compare comp) {
+			if (this == &other || other.empty()) return;
+			const size_type size = m_size + other.m_size;
+			attach(merge_hooks(detach(), other.detach(), comp));
+			m_size = size;
+		}
+
+		void splice(const_iterator pos, intrusive_list& other) {
+			if (this == &other || other.empty()) return;
+			hook_type* first = other.m_end.next;
+			hook_type* last = other.m_end.previous;
+			unlink(first, last);
+			link_before(pos.m_hook, first, last);
+			m_size += other.m_size;
+			other.m_size = 0;
+		}
+
+		void splice(const_iterator pos, intrusive_list& other, const_iterator it) {
+			hook_type* hook = it.m_hook;
+			if (pos.m_hook == hook || pos.m_hook == hook->next) return;
+			unlink(hook, hook);
+			link_before(pos.m_hook, hook, hook);
+			++m_size;
+			--other.m_size;
+		}
+
+		void splice(const_iterator pos, intrusive_list& other, const_iterator first, const_iterator last) {
+			if (first == last) return;
+			if (this != &other) {
+				const size_type count = std::distance(first, last);
+				m_size += count;
+				other.m_size -= count;
+			}
+			hook_type* back = last.m_hook->previous;
+			unlink(first.m_hook, back);
+			link_before(pos.m_hook, first.m_hook, back);
+		}
+
+		size_type remove(const value_type& val) {
+			return remove_if([&val](const value_type& elem) { return elem == val; });
+		}
+
+		template <class UnaryPredicate>
+		size_type remove_if(UnaryPredicate p) {
+			size_type removed_elems = 0;
+			for (iterator it = begin(); it != end();) {
+				if (p(*it)) {
+					it = erase(it);
+					++removed_elems;
+				} else {
+					++it;
+				}
+			}
+			return removed_elems;
+		}
+
+		size_type unique() { return unique(std::equal_to<value_type>()); }
+
+		template <class BinaryPredicate>
+		size_type unique(BinaryPredicate p) {
+			size_type removed_elems = 0;
+			if (empty()) return removed_elems;
+			for (iterator prev = begin(), it = std::next(prev); it != end();) {
+				if (p(*it, *prev)) {
+					it = erase(it);
+					++removed_elems;
+				} else {
+					prev = it++;
+				}
+			}
+			return removed_elems;
+		}
+
+		void reverse() {
+			hook_type* hook = &m_end;
+			do {
+				std::swap(hook->next, hook->previous);
+				hook = hook->previous;
+			} while (hook != &m_end);
+		}
+
+		void sort() { sort(std::less<value_type>()); }
+
+		/**
+		 * stable natural merge sort, see Forward_list::sort
+		 */
+		template <class Compare>
+		void sort(Compare comp) {
+			if (m_size < 2) return;
+			const size_type size = m_size;
+			attach(sort_hooks(detach(), comp));
+			m_size = size;
+		}
+
+	private:
+		hook_type m_end;
+		size_type m_size;
+
+		static void link_before(hook_type* pos, hook_type* first, hook_type* last) {
+			first->previous = pos->previous;
+			last->next = pos;
+			pos->previous->next = first;
+			pos->previous = last;
+		}
+
+		static void unlink(hook_type* first, hook_type* last) {
+			first->previous->next = last->next;
+			last->next->previous = first->previous;
+		}
+
+		/**
+		 * unlinks every object and returns them as a null terminated chain
+		 */
+		hook_type* detach() {
+			if (empty()) return nullptr;
+			hook_type* first = m_end.next;
+			m_end.previous->next = nullptr;
+			m_end.next = m_end.previous = &m_end;
+			m_size = 0;
+			return first;
+		}
+
+		/**
+		 * links a null terminated chain in front of the sentinel
+		 */
+		void attach(hook_type* first) {
+			if (!first) return;
+			hook_type* last = first;
+			for (; last->next; last = last->next)
+				last->next->previous = last;
+			link_before(&m_end, first, last);
+		}
+
+		template <class Compare>
+		static auto hook_less(Compare& comp) {
+			return [&comp](hook_type* lhs, hook_type* rhs) {
+				return comp(*hook_owner<T, hook_type, Hook>(lhs), *hook_owner<T, hook_type, Hook>(rhs));
+			};
+		}
+
+		template <class Compare>
+		static hook_type* merge_hooks(hook_type* first, hook_type* second, Compare& comp) {
+			auto less = hook_less(comp);
+			return detail::merge_chains(first, second, less);
+		}
+
+		template <class Compare>
+		static hook_type* sort_hooks(hook_type* head, Compare& comp) {
+			auto less = hook_less(comp);
+			return detail::sort_chain(head, less);
+		}
+	};
+}
+
+namespace std {
+	template <typename T, size_t Hook>
+	void swap(ds::intrusive_forward_list<T, Hook>& lhs, ds::intrusive_forward_list<T, Hook>& rhs) { lhs.swap(rhs); }
+
+	template <typename T, size_t Hook>
+	void swap(ds::intrusive_list<T, Hook>& lhs, ds::intrusive_list<T, Hook>& rhs) { lhs.swap(rhs); }
+}
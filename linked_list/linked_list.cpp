@@ -5,12 +5,17 @@
  * @version 0.1 18/8/18
  */
 
+#include "../forward_list/chain_sort.cpp"
+
 #include <stddef.h>
 #include <memory>
 #include <initializer_list>
 #include <iterator>
 #include <utility>
- 
+#include <functional>
+#include <algorithm>
+#include <type_traits>
+
 template<typename T, typename = void>
 struct is_iterator {
    static constexpr bool value = false;
@@ -23,19 +28,33 @@ struct is_iterator<T, typename std::enable_if<!std::is_same<typename std::iterat
 
 template<typename T>
 struct Node {
+
+	Node() : next(this), previous(this), value() {}
+	
+	T* val_ptr() {
+		return reinterpret_cast<T*>(&value);
+	}
+	
+	const T* val_ptr() const {
+		return reinterpret_cast<const T*>(&value);
+	}
+	
 	Node* next;
 	Node* previous;
-	T* value;
+	typename std::aligned_storage<sizeof(T), alignof(T)>::type value;
 };
 
-// Iterator class
+template <typename T, typename Allocator>
+class List;
+
+// Iterator classes
 
 template <typename T>
 class list_iterator {
 public:
 
 	// Member Classes
-
+	
 	using iterator_category = std::bidirectional_iterator_tag;
 	using value_type = T;
 	using difference_type = ptrdiff_t;
@@ -47,29 +66,23 @@ public:
 	// Constructors
 	list_iterator() : m_node() {}
 	
-	list_iterator(list_iterator&& rhs) : m_node(std::move(rhs.m_node)) {}
-	
-	list_iterator(const list_iterator& rhs) : m_node(rhs.m_node) {}
-	
-	list_iterator(const Node<value_type>* rhs) : m_node(rhs) {}
+	explicit list_iterator(Node<value_type>* node) : m_node(node) {}
 	
+	list_iterator(const list_iterator& rhs) = default;
 	
 	// Destructor
 	
 	~list_iterator() = default;
 	
 	// Operators
-	list_iterator& operator=(list_iterator&& rhs) {
-		m_node = std::move(rhs.m_node);
-		return *this;
-	}
+	list_iterator& operator=(const list_iterator& rhs) = default;
 	
-	list_iterator& operator=(const list_iterator& rhs) {
-		m_node = rhs.m_node;
+	reference operator*() const {
+		return *(m_node->val_ptr());
 	}
 	
-	const value_type& operator*() const {
-		return *(m_node->value);
+	pointer operator->() const {
+		return m_node->val_ptr();
 	}
 	
 	list_iterator& operator++() {
@@ -77,7 +90,7 @@ public:
 		return *this;
 	}
 	
-	list_iterator& operator++( int ) {
+	list_iterator operator++( int ) {
 		list_iterator tmp(*this);
 		m_node = m_node->next;
 		return tmp;
@@ -88,20 +101,12 @@ public:
 		return *this;
 	}
 	
-	list_iterator& operator--( int ) {
-		list_iterator tmp(this);
+	list_iterator operator--( int ) {
+		list_iterator tmp(*this);
 		m_node = m_node->previous;
 		return tmp;
 	}
 	
-	reference operator*() {
-		return *(m_node->value);
-	}
-	
-	reference operator->() {
-		return m_node.value;
-	}
-	
 	bool operator==(const list_iterator& rhs) const {
 		return m_node == rhs.m_node;
 	}
@@ -119,17 +124,115 @@ public:
 	friend void swap(list_iterator& lhs, list_iterator& rhs) {
 		lhs.swap(rhs);
 	}
-	
+
 private:
+	template <typename, typename> friend class List;
+	template <typename> friend class list_const_iterator;
+	
 	Node<value_type>* m_node;
 };
 
+template <typename T>
+class list_const_iterator {
+public:
+
+	// Member Classes
+	
+	using iterator_category = std::bidirectional_iterator_tag;
+	using value_type = T;
+	using difference_type = ptrdiff_t;
+	using pointer = const value_type*;
+	using reference = const value_type&;
+	
+	// Member Functions
+	
+	// Constructors
+	list_const_iterator() : m_node() {}
+	
+	explicit list_const_iterator(const Node<value_type>* node) : m_node(node) {}
+	
+	list_const_iterator(const list_iterator<value_type>& rhs) : m_node(rhs.m_node) {}
+	
+	list_const_iterator(const list_const_iterator& rhs) = default;
+	
+	// Destructor
+	
+	~list_const_iterator() = default;
+	
+	// Operators
+	list_const_iterator& operator=(const list_const_iterator& rhs) = default;
+	
+	reference operator*() const {
+		return *(m_node->val_ptr());
+	}
+	
+	pointer operator->() const {
+		return m_node->val_ptr();
+	}
+	
+	list_const_iterator& operator++() {
+		m_node = m_node->next;
+		return *this;
+	}
+	
+	list_const_iterator operator++( int ) {
+		list_const_iterator tmp(*this);
+		m_node = m_node->next;
+		return tmp;
+	}
+	
+	list_const_iterator& operator--() {
+		m_node = m_node->previous;
+		return *this;
+	}
+	
+	list_const_iterator operator--( int ) {
+		list_const_iterator tmp(*this);
+		m_node = m_node->previous;
+		return tmp;
+	}
+	
+	bool operator==(const list_const_iterator& rhs) const {
+		return m_node == rhs.m_node;
+	}
+	
+	bool operator!=(const list_const_iterator& rhs) const {
+		return m_node != rhs.m_node;
+	}
+	
+	// Swap
+	
+	void swap(list_const_iterator& rhs) {
+		std::swap(m_node, rhs.m_node);
+	}
+	
+	friend void swap(list_const_iterator& lhs, list_const_iterator& rhs) {
+		lhs.swap(rhs);
+	}
+
+private:
+	template <typename, typename> friend class List;
+	
+	const Node<value_type>* m_node;
+};
+
+/**
+ * Circular doubly linked list with a sentinel node. Values are stored inline
+ * in the nodes, which are allocated through a rebound copy of the allocator.
+ * Erased nodes are kept in a small per list cache and reused by the next
+ * insertion, so steady push/pop traffic does not reach the allocator.
+ */
 template <typename T, typename Allocator = std::allocator<T>>
 class List {
+
+	using Alloc_traits      = std::allocator_traits<Allocator>;
+	using Node_alloc_traits = typename Alloc_traits::template rebind_traits<Node<T>>;
+	using node_allocator    = typename Node_alloc_traits::allocator_type;
+
 public:
 
 	// Member Classes
-
+	
 	using value_type             = T;
 	using allocator_type         = Allocator;
 	using size_type              = size_t;
@@ -139,76 +242,115 @@ public:
 	using pointer                = typename std::allocator_traits<allocator_type>::pointer;
 	using const_pointer          = typename std::allocator_traits<allocator_type>::const_pointer;
 	using iterator               = list_iterator<value_type>;
-	using const_iterator         = list_iterator<const value_type>;
+	using const_iterator         = list_const_iterator<value_type>;
 	using reverse_iterator       = std::reverse_iterator<iterator>;
 	using const_reverse_iterator = std::reverse_iterator<const_iterator>;
-
-	// Member Functions
 	
-	List() : m_head(), m_end(), m_size(), m_allocator() {}
+	// maximum number of erased nodes kept for reuse
+	static constexpr size_type max_free_nodes = 64;
 	
-	explicit List(const allocator_type& alloc) : m_head(), m_end(), m_size(), m_allocator(alloc) {}
+	// Member Functions
+	
+	List() : List(allocator_type()) {}
 	
-	List(size_type count, const value_type& val, const allocator_type& alloc) : m_allocator(alloc) {
-		
+	explicit List(const allocator_type& alloc)
+		: m_size(), m_allocator(alloc), m_node_allocator(alloc), m_free(), m_free_count() {
+		m_end = allocate_node();
 	}
 	
-	explicit List(size_type count, const allocator_type& alloc = allocator_type()) : m_allocator(alloc) {
+	List(size_type count, const value_type& val, const allocator_type& alloc = allocator_type()) : List(alloc) {
+		insert(cend(), count, val);
+	}
 	
+	explicit List(size_type count, const allocator_type& alloc = allocator_type()) : List(alloc) {
+		resize(count);
 	}
 	
 	template <class InputIterator, class = typename std::enable_if<is_iterator<InputIterator>::value>::type>
-	List(InputIterator first, InputIterator last, const allocator_type& alloc) : m_allocator(alloc) {
-	
+	List(InputIterator first, InputIterator last, const allocator_type& alloc = allocator_type()) : List(alloc) {
+		insert(cend(), first, last);
 	}
 	
-	List(const List& other) : m_allocator() {
-	
+	List(const List& other) : List(Alloc_traits::select_on_container_copy_construction(other.m_allocator)) {
+		insert(cend(), other.begin(), other.end());
 	}
 	
-	List(const List& other, const allocator_type& alloc) : m_allocator(alloc) {
-	
+	List(const List& other, const allocator_type& alloc) : List(alloc) {
+		insert(cend(), other.begin(), other.end());
 	}
 	
-	List(List&& other) : m_allocator() {
-	
+	List(List&& other) : List(other.m_allocator) {
+		this->swap(other);
 	}
 	
-	List(List&& other, const allocator_type& alloc) : m_allocator(alloc) {
-	
+	List(List&& other, const allocator_type& alloc) : List(alloc) {
+		if (alloc == other.m_allocator) {
+			this->swap(other);
+		} else {
+			insert(cend(), std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+		}
 	}
 	
-	List(std::initializer_list<value_type> il, const allocator_type& alloc = allocator_type()) : m_allocator(alloc) {
-	
+	List(std::initializer_list<value_type> il, const allocator_type& alloc = allocator_type()) : List(alloc) {
+		insert(cend(), il);
 	}
 	
 	~List() {
-	
+		clear();
+		release_free_nodes();
+		deallocate_node(m_end);
 	}
 	
 	List& operator=(const List& other) {
-		
+		if (this != &other) {
+			assign(other.begin(), other.end());
+		}
+		return *this;
 	}
 	
 	List& operator=(List&& other) {
-	
+		this->swap(other);
+		return *this;
 	}
 	
 	List& operator=(std::initializer_list<value_type> il) {
-	
+		assign(il);
+		return *this;
 	}
 	
+	/**
+	 * replaces the contents with count copies of val, reusing existing nodes
+	 */
 	void assign(size_type count, const value_type& val) {
-	
-	}
-	
+		iterator it = begin();
+		for (; it != end() && count; ++it, --count) {
+			*it = val;
+		}
+		if (count) {
+			insert(cend(), count, val);
+		} else {
+			erase(it, end());
+		}
+	}
+	
+	/**
+	 * replaces the contents with the range [first, last), reusing existing nodes
+	 */
 	template <class InputIterator, class = typename std::enable_if<is_iterator<InputIterator>::value>::type>
 	void assign(InputIterator first, InputIterator last) {
-	
+		iterator it = begin();
+		for (; it != end() && first != last; ++it, ++first) {
+			*it = *first;
+		}
+		if (first != last) {
+			insert(cend(), first, last);
+		} else {
+			erase(it, end());
+		}
 	}
 	
 	void assign(std::initializer_list<value_type> il) {
-	
+		assign(il.begin(), il.end());
 	}
 	
 	allocator_type get_allocator() const {
@@ -218,75 +360,75 @@ public:
 	// Element Access
 	
 	reference front() {
-	
+		return *(m_end->next->val_ptr());
 	}
 	
 	const_reference front() const {
-	
+		return *(m_end->next->val_ptr());
 	}
 	
 	reference back() {
-	
+		return *(m_end->previous->val_ptr());
 	}
 	
 	const_reference back() const {
-	
+		return *(m_end->previous->val_ptr());
 	}
 	
 	// Iterators
 	
 	iterator begin() {
-	
+		return iterator(m_end->next);
 	}
 	
 	const_iterator begin() const {
-	
+		return const_iterator(m_end->next);
 	}
 	
 	const_iterator cbegin() const {
-	
+		return const_iterator(m_end->next);
 	}
 	
 	iterator end() {
-	
+		return iterator(m_end);
 	}
 	
 	const_iterator end() const {
-		
+		return const_iterator(m_end);
 	}
 	
 	const_iterator cend() const {
-		
+		return const_iterator(m_end);
 	}
-
-	reverse_iterator rbegin() {
 	
+	reverse_iterator rbegin() {
+		return reverse_iterator(end());
 	}
 	
 	const_reverse_iterator rbegin() const {
-	
+		return const_reverse_iterator(end());
 	}
 	
 	const_reverse_iterator crbegin() const {
-	
+		return const_reverse_iterator(cend());
 	}
 	
 	reverse_iterator rend() {
-	
+		return reverse_iterator(begin());
 	}
-
-	const_reverse_iterator rend() const {
 	
+	const_reverse_iterator rend() const {
+		return const_reverse_iterator(begin());
 	}
 	
 	const_reverse_iterator crend() const {
-	
+		return const_reverse_iterator(cbegin());
 	}
 	
 	// Capacity
 	
 	bool empty() const {
-		return m_head == m_end;
+		return m_size == 0;
 	}
 	
 	size_type size() const {
@@ -294,211 +436,480 @@ public:
 	}
 	
 	size_type max_size() const {
-	
+		return Node_alloc_traits::max_size(m_node_allocator);
 	}
 	
 	// Modifiers
 	
 	void clear() {
-	
+		erase(cbegin(), cend());
 	}
 	
 	iterator insert(const_iterator pos, const value_type& val) {
-	
+		return emplace(pos, val);
 	}
 	
 	iterator insert(const_iterator pos, value_type&& val) {
-	
+		return emplace(pos, std::move(val));
 	}
 	
-	iterator insert(const_iterator pos, size_type count, const value_type&) {
-	
+	iterator insert(const_iterator pos, size_type count, const value_type& val) {
+		iterator first = to_mutable(pos);
+		if (count) {
+			first = emplace(pos, val);
+			for (size_type n = 1; n < count; n++) {
+				emplace(pos, val);
+			}
+		}
+		return first;
 	}
 	
 	template <class InputIterator, class = typename std::enable_if<is_iterator<InputIterator>::value>::type>
 	iterator insert(const_iterator pos, InputIterator first, InputIterator last) {
-	
+		iterator inserted = to_mutable(pos);
+		if (first != last) {
+			inserted = emplace(pos, *first);
+			for (++first; first != last; ++first) {
+				emplace(pos, *first);
+			}
+		}
+		return inserted;
 	}
 	
 	iterator insert(const_iterator pos, std::initializer_list<value_type> il) {
-	
+		return insert(pos, il.begin(), il.end());
 	}
 	
 	template <class... Args>
 	iterator emplace(const_iterator pos, Args&&... args) {
-	
+		Node<value_type>* node = create_node(std::forward<Args>(args)...);
+		link_before(const_cast<Node<value_type>*>(pos.m_node), node, node);
+		++m_size;
+		return iterator(node);
 	}
 	
 	iterator erase(const_iterator pos) {
-	
+		Node<value_type>* node = const_cast<Node<value_type>*>(pos.m_node);
+		Node<value_type>* next = node->next;
+		unlink(node, node);
+		destroy_node(node);
+		--m_size;
+		return iterator(next);
 	}
 	
 	iterator erase(const_iterator first, const_iterator last) {
-	
+		while (first != last) {
+			first = erase(first);
+		}
+		return to_mutable(last);
 	}
 	
 	void push_back(const value_type& val) {
-	
+		emplace(cend(), val);
 	}
-
-	void push_back(value_type&& val) {
 	
+	void push_back(value_type&& val) {
+		emplace(cend(), std::move(val));
 	}
 	
 	template <class... Args>
 	reference emplace_back(Args&&... args) {
-	
+		return *emplace(cend(), std::forward<Args>(args)...);
 	}
 	
 	void pop_back() {
-	
+		erase(const_iterator(m_end->previous));
 	}
-
-	void push_front(const value_type& val) {
 	
+	void push_front(const value_type& val) {
+		emplace(cbegin(), val);
 	}
 	
 	void push_front(value_type&& val) {
-	
+		emplace(cbegin(), std::move(val));
 	}
 	
 	template <class... Args>
 	reference emplace_front(Args&&... args) {
-	
+		return *emplace(cbegin(), std::forward<Args>(args)...);
 	}
 	
 	void pop_front() {
-	
+		erase(cbegin());
 	}
 	
 	void resize(size_type count) {
-	
+		if (count < m_size) {
+			erase(position(count), cend());
+		} else {
+			for (size_type n = m_size; n < count; n++) {
+				emplace_back();
+			}
+		}
 	}
 	
 	void resize(size_type count, const value_type& val) {
-	
+		if (count < m_size) {
+			erase(position(count), cend());
+		} else {
+			insert(cend(), count - m_size, val);
+		}
 	}
 	
 	void swap(List& other) {
-		std::swap(this->m_head, other.m_head);
-		std::swap(this->m_end, other.m_end);
-		std::swap(this->m_size, other.m_size);
+		std::swap(m_end, other.m_end);
+		std::swap(m_size, other.m_size);
+		std::swap(m_allocator, other.m_allocator);
+		std::swap(m_node_allocator, other.m_node_allocator);
+		std::swap(m_free, other.m_free);
+		std::swap(m_free_count, other.m_free_count);
 	}
 	
 	// Operations
 	
 	void merge(List& other) {
-	
+		merge(other, std::less<value_type>());
 	}
 	
 	void merge(List&& other) {
-	
+		merge(other, std::less<value_type>());
 	}
 	
+	/**
+	 * moves the nodes of other into this list, both lists must be sorted
+	 * with respect to comp. Equivalent elements of this list come first.
+	 */
 	template <class Compare>
 	void merge(List& other, Compare comp) {
-	
+		if (this == &other || other.empty()) {
+			return;
+		}
+		Node<value_type>* first = detach();
+		Node<value_type>* second = other.detach();
+		attach(merge_nodes(first, second, comp));
+		m_size += other.m_size;
+		other.m_size = 0;
 	}
 	
 	template <class Compare>
 	void merge(List&& other, Compare comp) {
-	
+		merge(other, comp);
 	}
 	
 	void splice(const_iterator pos, List& other) {
-	
+		if (this == &other || other.empty()) {
+			return;
+		}
+		Node<value_type>* first = other.m_end->next;
+		Node<value_type>* last = other.m_end->previous;
+		other.unlink(first, last);
+		link_before(const_cast<Node<value_type>*>(pos.m_node), first, last);
+		m_size += other.m_size;
+		other.m_size = 0;
 	}
 	
 	void splice(const_iterator pos, List&& other) {
-	
+		splice(pos, other);
 	}
 	
 	void splice(const_iterator pos, List& other, const_iterator it) {
-	
+		Node<value_type>* node = const_cast<Node<value_type>*>(it.m_node);
+		if (pos.m_node == node || pos.m_node == node->next) {
+			return;
+		}
+		other.unlink(node, node);
+		link_before(const_cast<Node<value_type>*>(pos.m_node), node, node);
+		++m_size;
+		--other.m_size;
 	}
 	
 	void splice(const_iterator pos, List&& other, const_iterator it) {
-	
+		splice(pos, other, it);
 	}
 	
 	void splice(const_iterator pos, List& other, const_iterator first, const_iterator last) {
-	
+		if (first == last) {
+			return;
+		}
+		if (this != &other) {
+			const size_type count = std::distance(first, last);
+			m_size += count;
+			other.m_size -= count;
+		}
+		Node<value_type>* first_node = const_cast<Node<value_type>*>(first.m_node);
+		Node<value_type>* last_node = last.m_node->previous;
+		other.unlink(first_node, last_node);
+		link_before(const_cast<Node<value_type>*>(pos.m_node), first_node, last_node);
 	}
 	
 	void splice(const_iterator pos, List&& other, const_iterator first, const_iterator last) {
-	
+		splice(pos, other, first, last);
 	}
 	
 	size_type remove(const value_type& val) {
-	
+		// val may refer to an element of this list, so that one is erased last
+		const_iterator deferred = cend();
+		size_type removed_elems = 0;
+		for (const_iterator it = cbegin(); it != cend();) {
+			if (*it == val) {
+				if (std::addressof(*it) == std::addressof(val)) {
+					deferred = it++;
+					continue;
+				}
+				it = erase(it);
+				++removed_elems;
+			} else {
+				++it;
+			}
+		}
+		if (deferred != cend()) {
+			erase(deferred);
+			++removed_elems;
+		}
+		return removed_elems;
 	}
 	
 	template <class UnaryPredicate>
 	size_type remove_if(UnaryPredicate p) {
-	
+		size_type removed_elems = 0;
+		for (const_iterator it = cbegin(); it != cend();) {
+			if (p(*it)) {
+				it = erase(it);
+				++removed_elems;
+			} else {
+				++it;
+			}
+		}
+		return removed_elems;
 	}
 	
 	void reverse() {
-	
+		Node<value_type>* node = m_end;
+		do {
+			std::swap(node->next, node->previous);
+			node = node->previous;
+		} while (node != m_end);
 	}
-
-	size_type unique() {
 	
+	size_type unique() {
+		return unique(std::equal_to<value_type>());
 	}
 	
 	template <class BinaryPredicate>
 	size_type unique(BinaryPredicate p) {
-	
+		size_type removed_elems = 0;
+		if (empty()) {
+			return removed_elems;
+		}
+		for (const_iterator prev = cbegin(), it = std::next(prev); it != cend();) {
+			if (p(*it, *prev)) {
+				it = erase(it);
+				++removed_elems;
+			} else {
+				prev = it++;
+			}
+		}
+		return removed_elems;
 	}
 	
 	void sort() {
-	
+		sort(std::less<value_type>());
 	}
 	
+	/**
+	 * stable merge sort that relinks the existing nodes without allocating
+	 */
 	template <class Compare>
 	void sort(Compare comp) {
-	
+		if (m_size > 1) {
+			attach(sort_nodes(detach(), comp));
+		}
 	}
-	
+
 private:
-	Node<value_type>* m_head;
 	Node<value_type>* m_end;
 	size_type m_size;
 	allocator_type m_allocator;
+	node_allocator m_node_allocator;
+	Node<value_type>* m_free;
+	size_type m_free_count;
+	
+	static iterator to_mutable(const_iterator it) {
+		return iterator(const_cast<Node<value_type>*>(it.m_node));
+	}
+	
+	/**
+	 * returns an iterator to the nth element, walking from the closer end
+	 */
+	const_iterator position(size_type n) const {
+		const_iterator it;
+		if (n <= m_size/2) {
+			it = cbegin();
+			std::advance(it, n);
+		} else {
+			it = cend();
+			std::advance(it, -difference_type(m_size - n));
+		}
+		return it;
+	}
+	
+	/**
+	 * @brief returns uninitialised node storage, from the free cache if possible
+	 */
+	Node<value_type>* allocate_node() {
+		if (m_free) {
+			Node<value_type>* node = m_free;
+			m_free = node->next;
+			--m_free_count;
+			return node;
+		}
+		Node<value_type>* node = Node_alloc_traits::allocate(m_node_allocator, 1);
+		Node_alloc_traits::construct(m_node_allocator, node);
+		return node;
+	}
+	
+	void deallocate_node(Node<value_type>* node) {
+		Node_alloc_traits::destroy(m_node_allocator, node);
+		Node_alloc_traits::deallocate(m_node_allocator, node, 1);
+	}
+	
+	/**
+	 * @brief returns a node to the free cache, or to the allocator once the
+	 * cache holds max_free_nodes nodes
+	 */
+	void recycle_node(Node<value_type>* node) {
+		if (m_free_count < max_free_nodes) {
+			node->next = m_free;
+			m_free = node;
+			++m_free_count;
+		} else {
+			deallocate_node(node);
+		}
+	}
+	
+	void release_free_nodes() {
+		while (m_free) {
+			Node<value_type>* next = m_free->next;
+			deallocate_node(m_free);
+			m_free = next;
+		}
+		m_free_count = 0;
+	}
+	
+	template <class... Args>
+	Node<value_type>* create_node(Args&&... args) {
+		Node<value_type>* node = allocate_node();
+		try {
+			Alloc_traits::construct(m_allocator, node->val_ptr(), std::forward<Args>(args)...);
+		} catch (...) {
+			recycle_node(node);
+			throw;
+		}
+		return node;
+	}
+	
+	void destroy_node(Node<value_type>* node) {
+		Alloc_traits::destroy(m_allocator, node->val_ptr());
+		recycle_node(node);
+	}
+	
+	/**
+	 * @brief links the chain [first, last] in front of pos
+	 */
+	static void link_before(Node<value_type>* pos, Node<value_type>* first, Node<value_type>* last) {
+		first->previous = pos->previous;
+		last->next = pos;
+		pos->previous->next = first;
+		pos->previous = last;
+	}
+	
+	/**
+	 * @brief unlinks the chain [first, last] from the list
+	 */
+	static void unlink(Node<value_type>* first, Node<value_type>* last) {
+		first->previous->next = last->next;
+		last->next->previous = first->previous;
+	}
+	
+	/**
+	 * @brief unlinks every element from the list
+	 * @return the first node of the null terminated chain of removed nodes
+	 */
+	Node<value_type>* detach() {
+		if (empty()) {
+			return nullptr;
+		}
+		Node<value_type>* first = m_end->next;
+		m_end->previous->next = nullptr;
+		m_end->next = m_end;
+		m_end->previous = m_end;
+		return first;
+	}
+	
+	/**
+	 * @brief links a null terminated chain of nodes in front of m_end and
+	 * restores the previous pointers
+	 */
+	void attach(Node<value_type>* first) {
+		if (!first) {
+			return;
+		}
+		Node<value_type>* last = first;
+		for (; last->next; last = last->next) {
+			last->next->previous = last;
+		}
+		link_before(m_end, first, last);
+	}
+	
+	template <class Compare>
+	static Node<value_type>* merge_nodes(Node<value_type>* first, Node<value_type>* second, Compare& comp) {
+		auto less = node_less(comp);
+		return ds::detail::merge_chains(first, second, less);
+	}
 	
+	template <class Compare>
+	static Node<value_type>* sort_nodes(Node<value_type>* head, Compare& comp) {
+		auto less = node_less(comp);
+		return ds::detail::sort_chain(head, less);
+	}
+	
+	template <class Compare>
+	static auto node_less(Compare& comp) {
+		return [&comp](Node<value_type>* lhs, Node<value_type>* rhs) { return comp(*(lhs->val_ptr()), *(rhs->val_ptr())); };
+	}
 };
 
 template< class T, class Alloc >
 bool operator==( const List<T,Alloc>& lhs, const List<T,Alloc>& rhs ) {
-
+	return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
 }
 
 template< class T, class Alloc >
 bool operator!=( const List<T,Alloc>& lhs, const List<T,Alloc>& rhs ) {
-
+	return !(lhs == rhs);
 }
 
 template< class T, class Alloc >
 bool operator<( const List<T,Alloc>& lhs, const List<T,Alloc>& rhs ) {
-
+	return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
 }
 
 template< class T, class Alloc >
 bool operator<=( const List<T,Alloc>& lhs, const List<T,Alloc>& rhs ) {
-
+	return !(rhs < lhs);
 }
 
 template< class T, class Alloc >
 bool operator>( const List<T,Alloc>& lhs, const List<T,Alloc>& rhs ) {
-
+	return rhs < lhs;
 }
 
 template< class T, class Alloc >
 bool operator>=( const List<T,Alloc>& lhs, const List<T,Alloc>& rhs ) {
-
+	return !(lhs < rhs);
 }
 
 template < class T, class Alloc >
 void swap(List<T,Alloc>& lhs, List<T, Alloc>& rhs) {
-
+	lhs.swap(rhs);
 }
@@ -0,0 +1,366 @@
+/**
+ * Block compressed vector
+ *
+ * Append only vector of 64 bit integers compressed in blocks of 128. Each
+ * block is stored relative to a base and bit packed at the width its largest
+ * entry needs:
+ *
+ * frame_of_reference  entries are value - block minimum, good for ids
+ *                     clustered in a range; random access is O(1)
+ * delta               entries are the zigzag encoded differences between
+ *                     neighbours, good for sorted data such as timestamps;
+ *                     random access decodes up to 128 entries
+ *
+ * A block of width w takes exactly 2w words, so a block of timestamps a few
+ * milliseconds apart fits in a few bytes per value. The last, unfinished block
+ * stays uncompressed. Iterators decode a whole block at a time, four entries
+ * per step with AVX2 gathers and variable shifts when the CPU has them,
+ * chosen at run time like ds::simd.
+ */
+#include "../vector/Vector.cpp"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+namespace ds {
+
+	enum class block_encoding { frame_of_reference, delta };
+
+	namespace detail {
+
+		/**
+		 * unpacks count entries of width bits from words, adding base to each;
+		 * words must have one readable word past the packed bits
+		 */
+		inline void unpack_block(const uint64_t* words, unsigned width, uint64_t base,
+		                                                       uint64_t* out, size_t count) {
+			if (width == 0) {
+				std::fill(out, out + count, base);
+				return;
+			}
+			const uint64_t mask = width == 64 ? ~uint64_t(0) : (uint64_t(1) << width) - 1;
+			for (size_t i = 0; i < count; ++i) {
+				const size_t bit = i*width;
+				const unsigned offset = bit % 64;
+				const uint64_t* word = words + bit / 64;
+				out[i] = base + (((word[0] >> offset) | ((word[1] << 1) << (63 - offset))) & mask);
+			}
+		}
+
+#ifdef DS_SIMD_X86
+		/**
+		 * Unpacks four entries per step. Up to 57 bits an entry always fits in
+		 * the eight bytes starting at the byte holding its first bit, so one
+		 * byte granular gather and a variable shift per lane extract it; wider
+		 * entries gather the two words they may straddle and combine them.
+		 */
+		__attribute__((target("avx2"))) inline void unpack_block_avx2(const uint64_t* words, unsigned width, uint64_t base,
+		                                                              uint64_t* out, size_t count) {
+			if (width == 0) {
+				std::fill(out, out + count, base);
+				return;
+			}
+			const uint64_t scalar_mask = width == 64 ? ~uint64_t(0) : (uint64_t(1) << width) - 1;
+			const __m256i mask = _mm256_set1_epi64x(int64_t(scalar_mask));
+			const __m256i bases = _mm256_set1_epi64x(int64_t(base));
+			const __m256i step = _mm256_set1_epi64x(int64_t(4*width));
+			__m256i bit = _mm256_setr_epi64x(0, width, 2*width, 3*width);
+			size_t i = 0;
+			if (width <= 57) {
+				const long long* bytes = reinterpret_cast<const long long*>(words);
+				for (; i + 4 <= count; i += 4) {
+					const __m256i raw = _mm256_i64gather_epi64(bytes, _mm256_srli_epi64(bit, 3), 1);
+					const __m256i value = _mm256_srlv_epi64(raw, _mm256_and_si256(bit, _mm256_set1_epi64x(7)));
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i),
+					                    _mm256_add_epi64(_mm256_and_si256(value, mask), bases));
+					bit = _mm256_add_epi64(bit, step);
+				}
+			} else {
+				const long long* low = reinterpret_cast<const long long*>(words);
+				for (; i + 4 <= count; i += 4) {
+					const __m256i index = _mm256_srli_epi64(bit, 6);
+					const __m256i offset = _mm256_and_si256(bit, _mm256_set1_epi64x(63));
+					// a shift by 64 yields zero, so offset 0 takes nothing from the next word
+					const __m256i value = _mm256_or_si256(
+						_mm256_srlv_epi64(_mm256_i64gather_epi64(low, index, 8), offset),
+						_mm256_sllv_epi64(_mm256_i64gather_epi64(low + 1, index, 8),
+						                  _mm256_sub_epi64(_mm256_set1_epi64x(64), offset)));
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i),
+					                    _mm256_add_epi64(_mm256_and_si256(value, mask), bases));
+					bit = _mm256_add_epi64(bit, step);
+				}
+			}
+			// the entries past the last group of four, read like unpack_block does
+			for (; i < count; ++i) {
+				const size_t position = i*width;
+				const unsigned offset = position % 64;
+				const uint64_t* word = words + position / 64;
+				out[i] = base + (((word[0] >> offset) | ((word[1] << 1) << (63 - offset))) & scalar_mask);
+			}
+		}
+#endif
+	}
+
+	template <block_encoding encoding = block_encoding::frame_of_reference>
+	class block_packed_vector {
+	public:
+		typedef uint64_t value_type;
+		typedef size_t size_type;
+		typedef ptrdiff_t difference_type;
+
+		static constexpr size_type block_size = 128;
+
+		/**
+		 * Forward iterator that decodes one block into a buffer when it enters
+		 * it, so a sequential scan costs one unpack per 128 elements.
+		 */
+		class const_iterator {
+		public:
+			typedef std::forward_iterator_tag iterator_category;
+			typedef uint64_t value_type;
+			typedef ptrdiff_t difference_type;
+			typedef const uint64_t& reference;
+			typedef const uint64_t* pointer;
+
+			const_iterator() : m_vector(), m_index(), m_block(no_block) {}
+
+			const_iterator(const block_packed_vector* vector, size_type index)
+				: m_vector(vector), m_index(index), m_block(no_block) {}
+
+			reference operator*() const {
+				if (m_index / block_size != m_block) {
+					m_block = m_index / block_size;
+					m_vector->decode_block(m_block, m_buffer);
+				}
+				return m_buffer[m_index % block_size];
+			}
+
+			pointer operator->() const { return &**this; }
+
+			const_iterator& operator++() {
+				++m_index;
+				return *this;
+			}
+
+			const_iterator operator++(int) {
+				const_iterator old = *this;
+				++m_index;
+				return old;
+			}
+
+			bool operator==(const const_iterator& rhs) const { return m_index == rhs.m_index; }
+
+			bool operator!=(const const_iterator& rhs) const { return m_index != rhs.m_index; }
+
+		private:
+			static constexpr size_type no_block = size_type(-1);
+
+			const block_packed_vector* m_vector;
+			size_type m_index;
+			mutable size_type m_block;
+			mutable uint64_t m_buffer[block_size];
+		};
+
+		typedef const_iterator iterator;
+
+		// Constructors
+
+		block_packed_vector() : m_words(1, 0), m_tail_size(0), m_last(0) {}
+
+		template <class InputIterator, class = typename std::iterator_traits<InputIterator>::iterator_category>
+		block_packed_vector(InputIterator first, InputIterator last) : block_packed_vector() {
+			for (; first != last; ++first)
+				push_back(*first);
+		}
+
+		block_packed_vector(std::initializer_list<uint64_t> il) : block_packed_vector(il.begin(), il.end()) {}
+
+		// Iterators
+
+		const_iterator begin() const { return const_iterator(this, 0); }
+
+		const_iterator cbegin() const { return begin(); }
+
+		const_iterator end() const { return const_iterator(this, size()); }
+
+		const_iterator cend() const { return end(); }
+
+		// Capacity
+
+		size_type size() const { return m_blocks.size()*block_size + m_tail_size; }
+
+		bool empty() const { return size() == 0; }
+
+		/**
+		 * bytes used by the compressed blocks, their headers and the tail
+		 */
+		size_type memory() const {
+			return m_words.size()*sizeof(uint64_t) + m_blocks.size()*sizeof(block) + sizeof(m_tail);
+		}
+
+		// Element access
+
+		uint64_t operator[](size_type n) const {
+			const size_type index = n / block_size, entry = n % block_size;
+			if (index == m_blocks.size()) return m_tail[entry];
+
+			const block& b = m_blocks[index];
+			if (encoding == block_encoding::frame_of_reference) return read(b, entry);
+			uint64_t buffer[block_size];
+			decode_block(index, buffer);
+			return buffer[entry];
+		}
+
+		uint64_t at(size_type n) const {
+			if (n >= size()) throw std::out_of_range("ds::block_packed_vector::at");
+			return (*this)[n];
+		}
+
+		uint64_t front() const { return (*this)[0]; }
+
+		uint64_t back() const { return (*this)[size() - 1]; }
+
+		/**
+		 * @brief decodes block index into out
+		 * @return the number of elements written, block_size except for the tail
+		 */
+		size_type decode_block(size_type index, uint64_t* out) const {
+			if (index == m_blocks.size()) {
+				std::copy(m_tail, m_tail + m_tail_size, out);
+				return m_tail_size;
+			}
+
+			const block& b = m_blocks[index];
+			const uint64_t base = encoding == block_encoding::frame_of_reference ? b.base : 0;
+#ifdef DS_SIMD_X86
+			if (simd::supported() == simd::instruction_set::avx2)
+				detail::unpack_block_avx2(m_words.data() + b.word, b.width, base, out, block_size);
+			else
+#endif
+				detail::unpack_block(m_words.data() + b.word, b.width, base, out, block_size);
+
+			if (encoding == block_encoding::delta) {
+				uint64_t value = b.base;
+				for (size_type i = 0; i < block_size; ++i) {
+					value += unzigzag(out[i]);
+					out[i] = value;
+				}
+			}
+			return block_size;
+		}
+
+		// Modifiers
+
+		void push_back(uint64_t value) {
+			m_tail[m_tail_size++] = value;
+			if (m_tail_size == block_size) {
+				compress_tail();
+				m_tail_size = 0;
+			}
+		}
+
+		void clear() {
+			m_blocks.clear();
+			m_words.clear();
+			m_words.push_back(0);
+			m_tail_size = 0;
+			m_last = 0;
+		}
+
+		void swap(block_packed_vector& other) {
+			m_blocks.swap(other.m_blocks);
+			m_words.swap(other.m_words);
+			std::swap(m_tail, other.m_tail);
+			std::swap(m_tail_size, other.m_tail_size);
+			std::swap(m_last, other.m_last);
+		}
+
+	private:
+		struct block {
+			// the minimum, or for delta the value before the first entry
+			uint64_t base;
+			// first word of the packed entries in m_words
+			size_type word;
+			unsigned width;
+		};
+
+		Vector<block> m_blocks;
+		// packed entries of every block, then one zero word of padding
+		Vector<uint64_t> m_words;
+		uint64_t m_tail[block_size];
+		size_type m_tail_size;
+		// the last element of the last compressed block
+		uint64_t m_last;
+
+		static uint64_t zigzag(uint64_t delta) { return (delta << 1) ^ (0 - (delta >> 63)); }
+
+		static uint64_t unzigzag(uint64_t entry) { return (entry >> 1) ^ (0 - (entry & 1)); }
+
+		uint64_t read(const block& b, size_type entry) const {
+			if (b.width == 0) return b.base;
+			const size_type bit = entry*b.width;
+			const uint64_t* word = m_words.data() + b.word + bit / 64;
+			const unsigned offset = bit % 64;
+			const uint64_t mask = b.width == 64 ? ~uint64_t(0) : (uint64_t(1) << b.width) - 1;
+			return b.base + (((word[0] >> offset) | ((word[1] << 1) << (63 - offset))) & mask);
+		}
+
+		void compress_tail() {
+			uint64_t entries[block_size];
+			block b;
+			if (encoding == block_encoding::frame_of_reference) {
+				b.base = *std::min_element(m_tail, m_tail + block_size);
+				for (size_type i = 0; i < block_size; ++i)
+					entries[i] = m_tail[i] - b.base;
+			} else {
+				b.base = m_last;
+				uint64_t previous = b.base;
+				for (size_type i = 0; i < block_size; ++i) {
+					entries[i] = zigzag(m_tail[i] - previous);
+					previous = m_tail[i];
+				}
+			}
+
+			uint64_t all = 0;
+			for (size_type i = 0; i < block_size; ++i)
+				all |= entries[i];
+			b.width = all ? 64 - __builtin_clzll(all) : 0;
+
+			// replace the padding word with the block's 2w words, then pad again
+			b.word = m_words.size() - 1;
+			for (size_type i = 0; i < 2*b.width; ++i)
+				m_words.push_back(0);
+			for (size_type i = 0; i < block_size && b.width > 0; ++i) {
+				const size_type bit = i*b.width;
+				uint64_t* word = m_words.data() + b.word + bit / 64;
+				const unsigned offset = bit % 64;
+				word[0] |= entries[i] << offset;
+				if (offset + b.width > 64) word[1] |= entries[i] >> (64 - offset);
+			}
+			m_blocks.push_back(b);
+			m_last = m_tail[block_size - 1];
+		}
+	};
+
+	template <block_encoding encoding>
+	bool operator==(const block_packed_vector<encoding>& lhs, const block_packed_vector<encoding>& rhs) {
+		return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+	}
+
+	template <block_encoding encoding>
+	bool operator!=(const block_packed_vector<encoding>& lhs, const block_packed_vector<encoding>& rhs) {
+		return !(lhs == rhs);
+	}
+}
+
+namespace std {
+	template <ds::block_encoding encoding>
+	void swap(ds::block_packed_vector<encoding>& lhs, ds::block_packed_vector<encoding>& rhs) {
+		lhs.swap(rhs);
+	}
+}
@@ -0,0 +1,360 @@
+/**
+ * Bit packed vector
+ *
+ * Vector of unsigned integers stored in exactly width bits each, back to back
+ * in 64 bit words, so a million 20 bit ids take 2.5 MB instead of 8. An
+ * element may straddle two words; a zero word past the end lets every read
+ * load both without a bounds check. Storing a value wider than the current
+ * width repacks the whole vector at the wider width, so widths only grow.
+ */
+#include "../vector/Vector.cpp"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace ds {
+
+	template <class T = uint64_t>
+	class packed_vector {
+		static_assert(std::is_integral<T>::value && std::is_unsigned<T>::value && sizeof(T) <= 8,
+		              "ds::packed_vector: elements must be unsigned integers of at most 64 bits");
+
+	public:
+		typedef T value_type;
+		typedef size_t size_type;
+		typedef ptrdiff_t difference_type;
+		typedef T const_reference;
+
+		/**
+		 * proxy for one packed element
+		 */
+		class reference {
+		public:
+			operator T() const { return m_vector->get(m_index); }
+
+			reference& operator=(T value) {
+				m_vector->set(m_index, value);
+				return *this;
+			}
+
+			reference& operator=(const reference& other) { return *this = T(other); }
+
+		private:
+			friend class packed_vector;
+
+			reference(packed_vector* vector, size_type index) : m_vector(vector), m_index(index) {}
+
+			packed_vector* m_vector;
+			size_type m_index;
+		};
+
+		template <bool is_const>
+		class basic_iterator {
+			typedef typename std::conditional<is_const, const packed_vector*, packed_vector*>::type vector_pointer;
+
+		public:
+			typedef std::random_access_iterator_tag iterator_category;
+			typedef T value_type;
+			typedef ptrdiff_t difference_type;
+			typedef typename std::conditional<is_const, T, typename packed_vector::reference>::type reference;
+			typedef void pointer;
+
+			basic_iterator() : m_vector(), m_index() {}
+
+			basic_iterator(vector_pointer vector, size_type index) : m_vector(vector), m_index(index) {}
+
+			template <bool other_const, class = typename std::enable_if<is_const && !other_const>::type>
+			basic_iterator(const basic_iterator<other_const>& other) : m_vector(other.m_vector), m_index(other.m_index) {}
+
+			reference operator*() const { return (*m_vector)[m_index]; }
+
+			reference operator[](difference_type n) const { return (*m_vector)[m_index + n]; }
+
+			basic_iterator& operator++() {
+				++m_index;
+				return *this;
+			}
+
+			basic_iterator operator++(int) { return basic_iterator(m_vector, m_index++); }
+
+			basic_iterator& operator--() {
+				--m_index;
+				return *this;
+			}
+
+			basic_iterator operator--(int) { return basic_iterator(m_vector, m_index--); }
+
+			basic_iterator& operator+=(difference_type n) {
+				m_index += n;
+				return *this;
+			}
+
+			basic_iterator& operator-=(difference_type n) {
+				m_index -= n;
+				return *this;
+			}
+
+			basic_iterator operator+(difference_type n) const { return basic_iterator(m_vector, m_index + n); }
+
+			friend basic_iterator operator+(difference_type n, const basic_iterator& it) { return it + n; }
+
+			basic_iterator operator-(difference_type n) const { return basic_iterator(m_vector, m_index - n); }
+
+			difference_type operator-(const basic_iterator& rhs) const { return m_index - rhs.m_index; }
+
+			bool operator==(const basic_iterator& rhs) const { return m_index == rhs.m_index; }
+
+			bool operator!=(const basic_iterator& rhs) const { return m_index != rhs.m_index; }
+
+			bool operator<(const basic_iterator& rhs) const { return m_index < rhs.m_index; }
+
+			bool operator>(const basic_iterator& rhs) const { return m_index > rhs.m_index; }
+
+			bool operator<=(const basic_iterator& rhs) const { return m_index <= rhs.m_index; }
+
+			bool operator>=(const basic_iterator& rhs) const { return m_index >= rhs.m_index; }
+
+		private:
+			friend class packed_vector;
+
+			vector_pointer m_vector;
+			size_type m_index;
+		};
+
+		typedef basic_iterator<false> iterator;
+		typedef basic_iterator<true> const_iterator;
+
+		// Constructors
+
+		/**
+		 * an empty vector storing width bits per element
+		 */
+		explicit packed_vector(unsigned width = 1) : m_words(1, 0), m_size(0), m_width(checked_width(width)) {}
+
+		/**
+		 * n copies of value, at least width bits each
+		 */
+		packed_vector(size_type n, T value, unsigned width = 1)
+			: packed_vector(std::max(checked_width(width), bits_needed(value))) {
+			resize(n, value);
+		}
+
+		template <class InputIterator, class = typename std::iterator_traits<InputIterator>::iterator_category>
+		packed_vector(InputIterator first, InputIterator last, unsigned width = 1) : packed_vector(width) {
+			for (; first != last; ++first)
+				push_back(*first);
+		}
+
+		/**
+		 * packs il at the width of its largest element
+		 */
+		packed_vector(std::initializer_list<T> il) : packed_vector(il.size() ? bits_needed(std::max(il)) : 1) {
+			reserve(il.size());
+			for (T value : il)
+				push_back(value);
+		}
+
+		// Iterators
+
+		iterator begin() { return iterator(this, 0); }
+
+		const_iterator begin() const { return const_iterator(this, 0); }
+
+		const_iterator cbegin() const { return begin(); }
+
+		iterator end() { return iterator(this, m_size); }
+
+		const_iterator end() const { return const_iterator(this, m_size); }
+
+		const_iterator cend() const { return end(); }
+
+		// Capacity
+
+		size_type size() const { return m_size; }
+
+		bool empty() const { return m_size == 0; }
+
+		/**
+		 * bits per element
+		 */
+		unsigned width() const { return m_width; }
+
+		/**
+		 * bytes of packed storage in use
+		 */
+		size_type memory() const { return m_words.size()*sizeof(uint64_t); }
+
+		void reserve(size_type n) { m_words.reserve(words_for(n)); }
+
+		void shrink_to_fit() { m_words.shrink_to_fit(); }
+
+		void resize(size_type n, T value = 0) {
+			if (bits_needed(value) > m_width) repack(bits_needed(value));
+			const size_type old_size = m_size;
+			if (n < old_size) {
+				// clear the bits past the new end, so the padding word stays zero
+				for (size_type i = n; i < old_size; ++i)
+					write(i, 0);
+				m_words.resize(words_for(n));
+				m_size = n;
+				return;
+			}
+			m_words.resize(words_for(n), 0);
+			m_size = n;
+			if (value != 0)
+				for (size_type i = old_size; i < n; ++i)
+					write(i, value);
+		}
+
+		// Element access
+
+		T get(size_type n) const {
+			const size_type bit = n*m_width;
+			const uint64_t* word = m_words.data() + bit / 64;
+			const unsigned offset = bit % 64;
+			// the second shift is split so that offset 0 shifts out everything
+			const uint64_t value = (word[0] >> offset) | ((word[1] << 1) << (63 - offset));
+			return T(value & mask());
+		}
+
+		/**
+		 * stores value at n, widening every element first if it does not fit
+		 */
+		void set(size_type n, T value) {
+			if (bits_needed(value) > m_width) repack(bits_needed(value));
+			write(n, value);
+		}
+
+		reference operator[](size_type n) { return reference(this, n); }
+
+		T operator[](size_type n) const { return get(n); }
+
+		reference at(size_type n) {
+			if (n >= m_size) throw std::out_of_range("ds::packed_vector::at");
+			return (*this)[n];
+		}
+
+		T at(size_type n) const {
+			if (n >= m_size) throw std::out_of_range("ds::packed_vector::at");
+			return get(n);
+		}
+
+		reference front() { return (*this)[0]; }
+
+		T front() const { return get(0); }
+
+		reference back() { return (*this)[m_size - 1]; }
+
+		T back() const { return get(m_size - 1); }
+
+		/**
+		 * unpacks elements [first, first + count) into out
+		 */
+		void decode(size_type first, size_type count, T* out) const {
+			for (size_type i = 0; i < count; ++i)
+				out[i] = get(first + i);
+		}
+
+		// Modifiers
+
+		void push_back(T value) {
+			if (bits_needed(value) > m_width) repack(bits_needed(value));
+			// push_back rather than resize, which would reserve exactly
+			while (m_words.size() < words_for(m_size + 1))
+				m_words.push_back(0);
+			write(m_size++, value);
+		}
+
+		void pop_back() {
+			write(--m_size, 0);
+			m_words.resize(words_for(m_size));
+		}
+
+		void clear() {
+			m_words.clear();
+			m_words.push_back(0);
+			m_size = 0;
+		}
+
+		/**
+		 * @brief stores every element in width bits
+		 * @throws std::invalid_argument if an element needs more than width bits
+		 */
+		void repack(unsigned width) {
+			checked_width(width);
+			if (width == m_width) return;
+			if (width < m_width)
+				for (size_type i = 0; i < m_size; ++i)
+					if (bits_needed(get(i)) > width) throw std::invalid_argument("ds::packed_vector::repack: element too wide");
+
+			packed_vector packed(width);
+			packed.m_words.resize(packed.words_for(m_size), 0);
+			packed.m_size = m_size;
+			for (size_type i = 0; i < m_size; ++i)
+				packed.write(i, get(i));
+			swap(packed);
+		}
+
+		void swap(packed_vector& other) {
+			m_words.swap(other.m_words);
+			std::swap(m_size, other.m_size);
+			std::swap(m_width, other.m_width);
+		}
+
+		/**
+		 * the smallest width that holds value, at least one bit
+		 */
+		static unsigned bits_needed(T value) {
+			return value ? 64 - __builtin_clzll(static_cast<unsigned long long>(value)) : 1;
+		}
+
+	private:
+		// the last word is always zero padding
+		Vector<uint64_t> m_words;
+		size_type m_size;
+		unsigned m_width;
+
+		static unsigned checked_width(unsigned width) {
+			if (width == 0 || width > 8*sizeof(T)) throw std::invalid_argument("ds::packed_vector: width out of range");
+			return width;
+		}
+
+		uint64_t mask() const { return m_width == 64 ? ~uint64_t(0) : (uint64_t(1) << m_width) - 1; }
+
+		size_type words_for(size_type n) const { return (n*m_width + 63) / 64 + 1; }
+
+		void write(size_type n, uint64_t value) {
+			const size_type bit = n*m_width;
+			uint64_t* word = m_words.data() + bit / 64;
+			const unsigned offset = bit % 64;
+			word[0] = (word[0] & ~(mask() << offset)) | (value << offset);
+			if (offset + m_width > 64) {
+				const unsigned spill = 64 - offset;
+				word[1] = (word[1] & ~(mask() >> spill)) | (value >> spill);
+			}
+		}
+	};
+
+	template <class T>
+	bool operator==(const packed_vector<T>& lhs, const packed_vector<T>& rhs) {
+		return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+	}
+
+	template <class T>
+	bool operator!=(const packed_vector<T>& lhs, const packed_vector<T>& rhs) {
+		return !(lhs == rhs);
+	}
+}
+
+namespace std {
+	template <class T>
+	void swap(ds::packed_vector<T>& lhs, ds::packed_vector<T>& rhs) {
+		lhs.swap(rhs);
+	}
+}
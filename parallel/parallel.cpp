@@ -0,0 +1,280 @@
+/**
+ * Parallel algorithms
+ *
+ * Multi threaded versions of the standard algorithms for random access ranges
+ * such as Vector, run on ds::thread_pool::global(). A range is cut into a few
+ * chunks per worker so that stealing can even out uneven chunks; ranges
+ * shorter than one grain run on the calling thread.
+ *
+ * Functions and comparators are called concurrently from several threads
+ * and must not throw from sort and stable_sort.
+ */
+#include "thread_pool.cpp"
+#include "../vector/Vector.cpp"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ds {
+namespace parallel {
+
+	// elements per chunk below which splitting does not pay off
+	constexpr size_t default_grain = size_t(1) << 14;
+
+	// ranges shorter than this are sorted with std::sort on the calling thread
+	constexpr size_t sort_cutoff = size_t(1) << 16;
+
+	/**
+	 * calls f(begin, end) for [0, chunk), [chunk, 2 chunk), ... up to n, all
+	 * but the first on the pool, and returns once every call has finished
+	 */
+	template <class Function>
+	void split(size_t n, size_t chunk, Function f, thread_pool& pool = thread_pool::global()) {
+		if (n == 0) return;
+		if (chunk >= n) {
+			f(size_t(0), n);
+			return;
+		}
+		task_group group(pool);
+		for (size_t begin = chunk; begin < n; begin += chunk) {
+			const size_t end = std::min(begin + chunk, n);
+			group.run([&f, begin, end] { f(begin, end); });
+		}
+		f(size_t(0), chunk);
+		group.wait();
+	}
+
+	/**
+	 * splits [0, n) into chunks of at least grain elements, at most four per
+	 * worker, and calls f(begin, end) on each in parallel
+	 */
+	template <class Function>
+	void for_chunks(size_t n, size_t grain, Function f, thread_pool& pool = thread_pool::global()) {
+		const size_t chunks = std::max<size_t>(1, std::min((n + grain - 1) / grain, 4*pool.size()));
+		split(n, (n + chunks - 1) / chunks, f, pool);
+	}
+
+	template <class RandomIt, class Function>
+	void for_each(RandomIt first, RandomIt last, Function f) {
+		for_chunks(last - first, default_grain, [first, &f](size_t begin, size_t end) {
+			std::for_each(first + begin, first + end, f);
+		});
+	}
+
+	template <class RandomIt, class T>
+	void fill(RandomIt first, RandomIt last, const T& value) {
+		for_chunks(last - first, default_grain, [first, &value](size_t begin, size_t end) {
+			std::fill(first + begin, first + end, value);
+		});
+	}
+
+	template <class RandomIt, class OutputIt, class UnaryOperation>
+	OutputIt transform(RandomIt first, RandomIt last, OutputIt d_first, UnaryOperation op) {
+		for_chunks(last - first, default_grain, [first, d_first, &op](size_t begin, size_t end) {
+			std::transform(first + begin, first + end, d_first + begin, op);
+		});
+		return d_first + (last - first);
+	}
+
+	template <class RandomIt1, class RandomIt2, class OutputIt, class BinaryOperation>
+	OutputIt transform(RandomIt1 first1, RandomIt1 last1, RandomIt2 first2, OutputIt d_first, BinaryOperation op) {
+		for_chunks(last1 - first1, default_grain, [first1, first2, d_first, &op](size_t begin, size_t end) {
+			std::transform(first1 + begin, first1 + end, first2 + begin, d_first + begin, op);
+		});
+		return d_first + (last1 - first1);
+	}
+
+	/**
+	 * @brief folds [first, last) into init with op
+	 *
+	 * Each chunk is folded on its own and the partial results are combined
+	 * in order, so op must be associative but need not be commutative.
+	 */
+	template <class RandomIt, class T, class BinaryOperation = std::plus<T>>
+	T reduce(RandomIt first, RandomIt last, T init, BinaryOperation op = BinaryOperation()) {
+		const size_t n = last - first;
+		if (n == 0) return init;
+		thread_pool& pool = thread_pool::global();
+		const size_t chunks = std::min((n + default_grain - 1) / default_grain, 4*pool.size());
+		const size_t chunk = (n + chunks - 1) / chunks;
+
+		std::vector<T> partial((n + chunk - 1) / chunk, init);
+		split(n, chunk, [first, chunk, &op, &partial](size_t begin, size_t end) {
+			T sum = first[begin];
+			for (size_t i = begin + 1; i < end; ++i)
+				sum = op(std::move(sum), first[i]);
+			partial[begin / chunk] = std::move(sum);
+		}, pool);
+
+		for (T& sum : partial)
+			init = op(std::move(init), std::move(sum));
+		return init;
+	}
+
+	/**
+	 * @brief sorts [first, last) with a parallel sample sort
+	 *
+	 * Picks splitters from a random sample, moves every element to the
+	 * bucket between its splitters through a scratch buffer, then sorts the
+	 * buckets independently. Not stable.
+	 */
+	template <class RandomIt, class Compare>
+	void sort(RandomIt first, RandomIt last, Compare comp) {
+		typedef typename std::iterator_traits<RandomIt>::value_type value_type;
+
+		const size_t n = last - first;
+		thread_pool& pool = thread_pool::global();
+		if (n < sort_cutoff || pool.size() == 1) {
+			std::sort(first, last, comp);
+			return;
+		}
+
+		const size_t buckets = 4*pool.size();
+		const size_t oversample = 32;
+
+		std::vector<value_type> splitters;
+		{
+			std::vector<value_type> sample;
+			sample.reserve(buckets*oversample);
+			uint64_t seed = 0x9e3779b97f4a7c15 ^ n;
+			for (size_t i = 0; i < buckets*oversample; ++i) {
+				seed ^= seed << 13;
+				seed ^= seed >> 7;
+				seed ^= seed << 17;
+				sample.push_back(first[seed % n]);
+			}
+			std::sort(sample.begin(), sample.end(), comp);
+			for (size_t bucket = 1; bucket < buckets; ++bucket)
+				splitters.push_back(std::move(sample[bucket*oversample]));
+		}
+		auto bucket_of = [&splitters, &comp](const value_type& value) {
+			return size_t(std::upper_bound(splitters.begin(), splitters.end(), value, comp) - splitters.begin());
+		};
+
+		// counts[chunk][bucket], then the first output slot of each
+		const size_t chunks = buckets;
+		const size_t chunk = (n + chunks - 1) / chunks;
+		std::vector<std::vector<size_t>> counts(chunks, std::vector<size_t>(buckets, 0));
+		split(n, chunk, [first, chunk, &counts, &bucket_of](size_t begin, size_t end) {
+			std::vector<size_t>& count = counts[begin / chunk];
+			for (size_t i = begin; i < end; ++i)
+				++count[bucket_of(first[i])];
+		}, pool);
+
+		std::vector<size_t> bucket_start(buckets + 1, 0);
+		for (size_t bucket = 0, offset = 0; bucket < buckets; ++bucket) {
+			bucket_start[bucket] = offset;
+			for (std::vector<size_t>& count : counts) {
+				const size_t size = count[bucket];
+				count[bucket] = offset;
+				offset += size;
+			}
+		}
+		bucket_start[buckets] = n;
+
+		std::allocator<value_type> allocator;
+		value_type* buffer = allocator.allocate(n);
+		split(n, chunk, [first, chunk, buffer, &counts, &bucket_of](size_t begin, size_t end) {
+			std::vector<size_t>& next = counts[begin / chunk];
+			for (size_t i = begin; i < end; ++i)
+				::new (static_cast<void*>(buffer + next[bucket_of(first[i])]++)) value_type(std::move(first[i]));
+		}, pool);
+
+		task_group group(pool);
+		for (size_t bucket = 0; bucket < buckets; ++bucket) {
+			const size_t begin = bucket_start[bucket], end = bucket_start[bucket + 1];
+			group.run([first, buffer, begin, end, &comp] {
+				std::move(buffer + begin, buffer + end, first + begin);
+				std::destroy(buffer + begin, buffer + end);
+				std::sort(first + begin, first + end, comp);
+			});
+		}
+		group.wait();
+		allocator.deallocate(buffer, n);
+	}
+
+	template <class RandomIt>
+	void sort(RandomIt first, RandomIt last) {
+		parallel::sort(first, last, std::less<typename std::iterator_traits<RandomIt>::value_type>());
+	}
+
+	/**
+	 * @brief stable sorts [first, last)
+	 *
+	 * Sorts one run per worker in parallel, then merges neighbouring runs in
+	 * rounds, each round's merges running in parallel.
+	 */
+	template <class RandomIt, class Compare>
+	void stable_sort(RandomIt first, RandomIt last, Compare comp) {
+		const size_t n = last - first;
+		thread_pool& pool = thread_pool::global();
+		if (n < sort_cutoff || pool.size() == 1) {
+			std::stable_sort(first, last, comp);
+			return;
+		}
+
+		const size_t run = (n + pool.size() - 1) / pool.size();
+		split(n, run, [first, &comp](size_t begin, size_t end) {
+			std::stable_sort(first + begin, first + end, comp);
+		}, pool);
+
+		for (size_t width = run; width < n; width *= 2) {
+			task_group group(pool);
+			for (size_t begin = 0; begin + width < n; begin += 2*width) {
+				const size_t middle = begin + width, end = std::min(begin + 2*width, n);
+				group.run([first, begin, middle, end, &comp] {
+					std::inplace_merge(first + begin, first + middle, first + end, comp);
+				});
+			}
+			group.wait();
+		}
+	}
+
+	template <class RandomIt>
+	void stable_sort(RandomIt first, RandomIt last) {
+		parallel::stable_sort(first, last, std::less<typename std::iterator_traits<RandomIt>::value_type>());
+	}
+
+	/**
+	 * @brief replaces the contents of dst with [first, last)
+	 *
+	 * For trivially copyable elements the storage is allocated without being
+	 * initialized and filled by memcpy from every worker, which also places
+	 * each page on the node of the worker that copies it. Other element types
+	 * are copied by Vector::assign on the calling thread.
+	 */
+	template <class T, size_t growth_factor, class Alloc>
+	void assign(Vector<T, growth_factor, Alloc>& dst, const T* first, const T* last) {
+		if constexpr (std::is_trivially_copyable<T>::value && std::is_trivially_default_constructible<T>::value) {
+			dst.clear();
+			// trivially default constructible, so resize only allocates
+			dst.resize(last - first);
+			T* out = dst.data();
+			for_chunks(last - first, default_grain, [first, out](size_t begin, size_t end) {
+				memcpy(static_cast<void*>(out + begin), first + begin, (end - begin)*sizeof(T));
+			});
+		} else {
+			dst.assign(first, last);
+		}
+	}
+
+	/**
+	 * a copy of src made by parallel::assign, using src's allocator
+	 */
+	template <class T, size_t growth_factor, class Alloc>
+	Vector<T, growth_factor, Alloc> copy(const Vector<T, growth_factor, Alloc>& src) {
+		Vector<T, growth_factor, Alloc> dst(src.get_allocator());
+		assign(dst, src.data(), src.data() + src.size());
+		return dst;
+	}
+}
+}
@@ -0,0 +1,220 @@
+/**
+ * Work stealing thread pool
+ *
+ * Each worker owns a deque of tasks. It pushes and pops at the back, so it
+ * runs the work it just spawned while that data is still in cache. An idle
+ * worker steals from the front of another worker's deque, which holds the
+ * oldest and usually largest pieces of work. Tasks submitted from outside
+ * the pool are spread over the deques round robin.
+ *
+ * A task_group is the fork join handle: run() spawns tasks and wait() blocks
+ * until they have finished. While it waits, the calling thread runs pending
+ * tasks, so groups can nest inside pool tasks without deadlocking.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ds {
+
+	class thread_pool {
+	public:
+		typedef std::function<void()> task_type;
+
+		explicit thread_pool(size_t threads = std::max(1u, std::thread::hardware_concurrency()))
+			: m_queues(threads), m_queued(0), m_next_queue(0), m_stop(false) {
+			for (size_t n = 0; n < threads; ++n)
+				m_queues[n].reset(new task_queue);
+			for (size_t n = 0; n < threads; ++n)
+				m_workers.emplace_back([this, n] { work(n); });
+		}
+
+		thread_pool(const thread_pool&) = delete;
+
+		thread_pool& operator=(const thread_pool&) = delete;
+
+		/**
+		 * finishes the queued tasks, then joins the workers
+		 */
+		~thread_pool() {
+			{
+				std::lock_guard<std::mutex> lock(m_sleep_mutex);
+				m_stop = true;
+			}
+			m_wake.notify_all();
+			for (std::thread& worker : m_workers)
+				worker.join();
+		}
+
+		size_t size() const { return m_workers.size(); }
+
+		/**
+		 * queues task on the calling worker's own deque, or on the next deque
+		 * in turn when called from outside the pool
+		 */
+		void submit(task_type task) {
+			const size_t queue = local_index() != no_worker && local_pool() == this
+				? local_index() : m_next_queue.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+			{
+				std::lock_guard<std::mutex> lock(m_queues[queue]->mutex);
+				m_queues[queue]->tasks.push_back(std::move(task));
+			}
+			m_queued.fetch_add(1, std::memory_order_release);
+			// the lock orders the increment against a worker checking it before sleeping
+			{ std::lock_guard<std::mutex> lock(m_sleep_mutex); }
+			m_wake.notify_one();
+		}
+
+		/**
+		 * runs one queued task on the calling thread, returns false if there
+		 * was none
+		 */
+		bool run_one() {
+			task_type task;
+			if (!take(local_pool() == this ? local_index() : no_worker, task)) return false;
+			task();
+			return true;
+		}
+
+		/**
+		 * the pool shared by the ds::parallel algorithms, one worker per core
+		 */
+		static thread_pool& global() {
+			static thread_pool pool;
+			return pool;
+		}
+
+	private:
+		struct task_queue {
+			std::mutex mutex;
+			std::deque<task_type> tasks;
+		};
+
+		static constexpr size_t no_worker = size_t(-1);
+
+		std::vector<std::unique_ptr<task_queue>> m_queues;
+		std::vector<std::thread> m_workers;
+		std::atomic<size_t> m_queued;
+		std::atomic<size_t> m_next_queue;
+		std::mutex m_sleep_mutex;
+		std::condition_variable m_wake;
+		bool m_stop;
+
+		static size_t& local_index() {
+			static thread_local size_t index = no_worker;
+			return index;
+		}
+
+		static thread_pool*& local_pool() {
+			static thread_local thread_pool* pool = nullptr;
+			return pool;
+		}
+
+		/**
+		 * pops the back of the own deque, otherwise steals the front of another
+		 */
+		bool take(size_t own, task_type& task) {
+			if (m_queued.load(std::memory_order_acquire) == 0) return false;
+			if (own != no_worker) {
+				std::lock_guard<std::mutex> lock(m_queues[own]->mutex);
+				if (!m_queues[own]->tasks.empty()) {
+					task = std::move(m_queues[own]->tasks.back());
+					m_queues[own]->tasks.pop_back();
+					m_queued.fetch_sub(1, std::memory_order_relaxed);
+					return true;
+				}
+			}
+			const size_t start = own == no_worker ? 0 : own + 1;
+			for (size_t n = 0; n < m_queues.size(); ++n) {
+				task_queue& victim = *m_queues[(start + n) % m_queues.size()];
+				std::lock_guard<std::mutex> lock(victim.mutex);
+				if (!victim.tasks.empty()) {
+					task = std::move(victim.tasks.front());
+					victim.tasks.pop_front();
+					m_queued.fetch_sub(1, std::memory_order_relaxed);
+					return true;
+				}
+			}
+			return false;
+		}
+
+		void work(size_t index) {
+			local_index() = index;
+			local_pool() = this;
+			for (;;) {
+				task_type task;
+				if (take(index, task)) {
+					task();
+					continue;
+				}
+				std::unique_lock<std::mutex> lock(m_sleep_mutex);
+				m_wake.wait(lock, [this] { return m_stop || m_queued.load(std::memory_order_acquire) > 0; });
+				if (m_stop && m_queued.load(std::memory_order_acquire) == 0) return;
+			}
+		}
+	};
+
+	/**
+	 * Spawns tasks on a pool and waits for all of them. The first exception a
+	 * task throws is rethrown by wait(); tasks spawned before it still run.
+	 */
+	class task_group {
+	public:
+		explicit task_group(thread_pool& pool = thread_pool::global()) : m_pool(pool), m_pending(0) {}
+
+		task_group(const task_group&) = delete;
+
+		task_group& operator=(const task_group&) = delete;
+
+		~task_group() {
+			while (m_pending.load(std::memory_order_acquire) > 0)
+				if (!m_pool.run_one()) std::this_thread::yield();
+		}
+
+		template <class Function>
+		void run(Function f) {
+			m_pending.fetch_add(1, std::memory_order_relaxed);
+			m_pool.submit([this, f]() mutable {
+				try {
+					f();
+				} catch (...) {
+					std::lock_guard<std::mutex> lock(m_error_mutex);
+					if (!m_error) m_error = std::current_exception();
+				}
+				m_pending.fetch_sub(1, std::memory_order_release);
+			});
+		}
+
+		/**
+		 * runs queued tasks until every task of the group has finished
+		 */
+		void wait() {
+			while (m_pending.load(std::memory_order_acquire) > 0)
+				if (!m_pool.run_one()) std::this_thread::yield();
+			if (m_error) {
+				std::exception_ptr error;
+				std::swap(error, m_error);
+				std::rethrow_exception(error);
+			}
+		}
+
+		thread_pool& pool() const { return m_pool; }
+
+	private:
+		thread_pool& m_pool;
+		std::atomic<size_t> m_pending;
+		std::mutex m_error_mutex;
+		std::exception_ptr m_error;
+	};
+}
@@ -0,0 +1,454 @@
+/**
+ * Ring buffer
+ *
+ * Double ended queue over one circular array. The capacity is always a power of
+ * two, so an index wraps with a mask instead of a division, and head is left to
+ * run freely through the unsigned range. Pushing or popping at either end is
+ * O(1); a full buffer doubles and unrolls its elements to the front of the new
+ * array.
+ *
+ * With fixed_capacity set the array is allocated once with that many slots and
+ * pushing onto a full buffer throws std::length_error instead of growing, so
+ * references stay valid until their element is popped.
+ */
+#include <stddef.h>
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace ds {
+
+	template <class T, size_t fixed_capacity = 0, class Allocator = std::allocator<T>>
+	class ring_buffer {
+
+		typedef std::allocator_traits<Allocator> Alloc_traits;
+
+		static_assert((fixed_capacity & (fixed_capacity - 1)) == 0,
+		              "ds::ring_buffer: fixed_capacity must be zero or a power of two");
+
+	public:
+		typedef T value_type;
+		typedef Allocator allocator_type;
+		typedef size_t size_type;
+		typedef ptrdiff_t difference_type;
+		typedef value_type& reference;
+		typedef const value_type& const_reference;
+		typedef typename Alloc_traits::pointer pointer;
+		typedef typename Alloc_traits::const_pointer const_pointer;
+
+		template <bool is_const>
+		class basic_iterator {
+			typedef typename std::conditional<is_const, const ring_buffer*, ring_buffer*>::type buffer_pointer;
+
+		public:
+			typedef std::random_access_iterator_tag iterator_category;
+			typedef T value_type;
+			typedef ptrdiff_t difference_type;
+			typedef typename std::conditional<is_const, const T*, T*>::type pointer;
+			typedef typename std::conditional<is_const, const T&, T&>::type reference;
+
+			basic_iterator() : m_buffer(), m_index() {}
+
+			basic_iterator(buffer_pointer buffer, size_type index) : m_buffer(buffer), m_index(index) {}
+
+			template <bool other_const, class = typename std::enable_if<is_const && !other_const>::type>
+			basic_iterator(const basic_iterator<other_const>& other) : m_buffer(other.m_buffer), m_index(other.m_index) {}
+
+			reference operator*() const { return (*m_buffer)[m_index]; }
+
+			pointer operator->() const { return &(*m_buffer)[m_index]; }
+
+			reference operator[](difference_type n) const { return (*m_buffer)[m_index + n]; }
+
+			basic_iterator& operator++() {
+				++m_index;
+				return *this;
+			}
+
+			basic_iterator operator++(int) { return basic_iterator(m_buffer, m_index++); }
+
+			basic_iterator& operator--() {
+				--m_index;
+				return *this;
+			}
+
+			basic_iterator operator--(int) { return basic_iterator(m_buffer, m_index--); }
+
+			basic_iterator& operator+=(difference_type n) {
+				m_index += n;
+				return *this;
+			}
+
+			basic_iterator& operator-=(difference_type n) {
+				m_index -= n;
+				return *this;
+			}
+
+			basic_iterator operator+(difference_type n) const { return basic_iterator(m_buffer, m_index + n); }
+
+			friend basic_iterator operator+(difference_type n, const basic_iterator& it) { return it + n; }
+
+			basic_iterator operator-(difference_type n) const { return basic_iterator(m_buffer, m_index - n); }
+
+			difference_type operator-(const basic_iterator& rhs) const { return m_index - rhs.m_index; }
+
+			bool operator==(const basic_iterator& rhs) const { return m_index == rhs.m_index; }
+
+			bool operator!=(const basic_iterator& rhs) const { return m_index != rhs.m_index; }
+
+			bool operator<(const basic_iterator& rhs) const { return m_index < rhs.m_index; }
+
+			bool operator>(const basic_iterator& rhs) const { return m_index > rhs.m_index; }
+
+			bool operator<=(const basic_iterator& rhs) const { return m_index <= rhs.m_index; }
+
+			bool operator>=(const basic_iterator& rhs) const { return m_index >= rhs.m_index; }
+
+		private:
+			friend class ring_buffer;
+
+			buffer_pointer m_buffer;
+			size_type m_index;
+		};
+
+		typedef basic_iterator<false> iterator;
+		typedef basic_iterator<true> const_iterator;
+		typedef std::reverse_iterator<iterator> reverse_iterator;
+		typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+		// Constructors, Destructors and Assignment
+
+		ring_buffer() : ring_buffer(allocator_type()) {}
+
+		explicit ring_buffer(const allocator_type& alloc)
+			: m_buffer(), m_capacity(0), m_head(0), m_size(0), m_allocator(alloc) {}
+
+		ring_buffer(size_type count, const value_type& val, const allocator_type& alloc = allocator_type())
+			: ring_buffer(alloc) {
+			reserve(count);
+			for (; count > 0; --count)
+				emplace_back(val);
+		}
+
+		template <class InputIterator, class = typename std::iterator_traits<InputIterator>::iterator_category>
+		ring_buffer(InputIterator first, InputIterator last, const allocator_type& alloc = allocator_type())
+			: ring_buffer(alloc) {
+			for (; first != last; ++first)
+				emplace_back(*first);
+		}
+
+		ring_buffer(std::initializer_list<value_type> il, const allocator_type& alloc = allocator_type())
+			: ring_buffer(alloc) {
+			reserve(il.size());
+			for (const value_type& val : il)
+				emplace_back(val);
+		}
+
+		ring_buffer(const ring_buffer& other)
+			: ring_buffer(Alloc_traits::select_on_container_copy_construction(other.m_allocator)) {
+			reserve(other.size());
+			for (const value_type& val : other)
+				emplace_back(val);
+		}
+
+		ring_buffer(ring_buffer&& other) noexcept : ring_buffer(std::move(other.m_allocator)) { swap(other); }
+
+		~ring_buffer() {
+			clear();
+			deallocate(m_buffer, m_capacity);
+		}
+
+		ring_buffer& operator=(const ring_buffer& other) {
+			if (this != &other) {
+				ring_buffer tmp(other);
+				swap(tmp);
+			}
+			return *this;
+		}
+
+		ring_buffer& operator=(ring_buffer&& other) noexcept {
+			swap(other);
+			return *this;
+		}
+
+		ring_buffer& operator=(std::initializer_list<value_type> il) {
+			ring_buffer tmp(il, m_allocator);
+			swap(tmp);
+			return *this;
+		}
+
+		allocator_type get_allocator() const { return m_allocator; }
+
+		// Element access
+
+		reference operator[](size_type n) { return m_buffer[slot(n)]; }
+
+		const_reference operator[](size_type n) const { return m_buffer[slot(n)]; }
+
+		reference at(size_type n) {
+			if (n >= m_size) throw std::out_of_range("ds::ring_buffer::at");
+			return (*this)[n];
+		}
+
+		const_reference at(size_type n) const {
+			if (n >= m_size) throw std::out_of_range("ds::ring_buffer::at");
+			return (*this)[n];
+		}
+
+		reference front() { return (*this)[0]; }
+
+		const_reference front() const { return (*this)[0]; }
+
+		reference back() { return (*this)[m_size - 1]; }
+
+		const_reference back() const { return (*this)[m_size - 1]; }
+
+		// Iterators
+
+		iterator begin() { return iterator(this, 0); }
+
+		const_iterator begin() const { return const_iterator(this, 0); }
+
+		const_iterator cbegin() const { return begin(); }
+
+		iterator end() { return iterator(this, m_size); }
+
+		const_iterator end() const { return const_iterator(this, m_size); }
+
+		const_iterator cend() const { return end(); }
+
+		reverse_iterator rbegin() { return reverse_iterator(end()); }
+
+		const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+
+		const_reverse_iterator crbegin() const { return rbegin(); }
+
+		reverse_iterator rend() { return reverse_iterator(begin()); }
+
+		const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+		const_reverse_iterator crend() const { return rend(); }
+
+		// Capacity
+
+		size_type size() const { return m_size; }
+
+		bool empty() const { return m_size == 0; }
+
+		/**
+		 * true when the next push has to grow, or throws with a fixed capacity
+		 */
+		bool full() const { return m_size == m_capacity; }
+
+		size_type capacity() const { return m_capacity; }
+
+		size_type max_size() const { return fixed_capacity ? fixed_capacity : Alloc_traits::max_size(m_allocator); }
+
+		/**
+		 * grows to the smallest power of two holding n elements
+		 */
+		void reserve(size_type n) {
+			if (n <= m_capacity) return;
+			if (n > max_size()) throw std::length_error("ds::ring_buffer::reserve");
+			reallocate(fixed_capacity ? fixed_capacity : round_up(n));
+		}
+
+		/**
+		 * shrinks to the smallest power of two holding size() elements, does
+		 * nothing with a fixed capacity
+		 */
+		void shrink_to_fit() {
+			if (fixed_capacity) return;
+			if (empty()) {
+				deallocate(m_buffer, m_capacity);
+				m_buffer = pointer();
+				m_capacity = 0;
+				m_head = 0;
+			} else if (round_up(m_size) < m_capacity) {
+				reallocate(round_up(m_size));
+			}
+		}
+
+		// Modifiers
+
+		void clear() {
+			for (; m_size > 0; --m_size)
+				Alloc_traits::destroy(m_allocator, &m_buffer[slot(m_size - 1)]);
+			m_head = 0;
+		}
+
+		void push_back(const value_type& val) { emplace_back(val); }
+
+		void push_back(value_type&& val) { emplace_back(std::move(val)); }
+
+		void push_front(const value_type& val) { emplace_front(val); }
+
+		void push_front(value_type&& val) { emplace_front(std::move(val)); }
+
+		template <class... Args>
+		reference emplace_back(Args&&... args) {
+			if (full()) {
+				grow_emplace(false, std::forward<Args>(args)...);
+				return back();
+			}
+			Alloc_traits::construct(m_allocator, &m_buffer[slot(m_size)], std::forward<Args>(args)...);
+			++m_size;
+			return back();
+		}
+
+		template <class... Args>
+		reference emplace_front(Args&&... args) {
+			if (full()) {
+				grow_emplace(true, std::forward<Args>(args)...);
+				return front();
+			}
+			Alloc_traits::construct(m_allocator, &m_buffer[(m_head - 1) & (m_capacity - 1)], std::forward<Args>(args)...);
+			--m_head;
+			++m_size;
+			return front();
+		}
+
+		void pop_back() {
+			Alloc_traits::destroy(m_allocator, &back());
+			--m_size;
+		}
+
+		void pop_front() {
+			Alloc_traits::destroy(m_allocator, &front());
+			++m_head;
+			--m_size;
+		}
+
+		void swap(ring_buffer& other) noexcept {
+			using std::swap;
+			swap(m_buffer, other.m_buffer);
+			swap(m_capacity, other.m_capacity);
+			swap(m_head, other.m_head);
+			swap(m_size, other.m_size);
+			swap(m_allocator, other.m_allocator);
+		}
+
+	private:
+		pointer m_buffer;
+		size_type m_capacity;
+		// position of the front element before masking, wraps around freely
+		size_type m_head;
+		size_type m_size;
+		allocator_type m_allocator;
+
+		size_type slot(size_type n) const { return (m_head + n) & (m_capacity - 1); }
+
+		static size_type round_up(size_type n) {
+			size_type capacity = 1;
+			while (capacity < n)
+				capacity <<= 1;
+			return capacity;
+		}
+
+		pointer allocate(size_type n) { return n != 0 ? Alloc_traits::allocate(m_allocator, n) : pointer(); }
+
+		void deallocate(pointer p, size_type n) {
+			if (p) Alloc_traits::deallocate(m_allocator, p, n);
+		}
+
+		/**
+		 * Grows a full buffer and constructs an element at its back, or at its
+		 * front if at_front is set. The element is constructed in the new array
+		 * before the old elements move out, so args may refer to one of them;
+		 * if anything throws the buffer is left unchanged.
+		 */
+		template <class... Args>
+		void grow_emplace(bool at_front, Args&&... args) {
+			if (fixed_capacity && m_capacity == fixed_capacity) throw std::length_error("ds::ring_buffer: buffer is full");
+			const size_type n = fixed_capacity ? fixed_capacity : std::max<size_type>(2*m_capacity, 1);
+
+			// the old elements go to the start of the array, so the last slot
+			// is free for a new front element
+			const size_type position = at_front ? n - 1 : m_size;
+			pointer buffer = allocate(n);
+			try {
+				Alloc_traits::construct(m_allocator, &buffer[position], std::forward<Args>(args)...);
+			} catch (...) {
+				deallocate(buffer, n);
+				throw;
+			}
+			try {
+				move_to(buffer);
+			} catch (...) {
+				Alloc_traits::destroy(m_allocator, &buffer[position]);
+				deallocate(buffer, n);
+				throw;
+			}
+			const size_type size = m_size;
+			adopt(buffer, n);
+			m_head = at_front ? n - 1 : 0;
+			m_size = size + 1;
+		}
+
+		/**
+		 * moves the elements, front first, to the start of a new array of n
+		 * slots; if a move throws the buffer is left unchanged
+		 */
+		void reallocate(size_type n) {
+			pointer buffer = allocate(n);
+			try {
+				move_to(buffer);
+			} catch (...) {
+				deallocate(buffer, n);
+				throw;
+			}
+			const size_type size = m_size;
+			adopt(buffer, n);
+			m_size = size;
+		}
+
+		/**
+		 * constructs the elements, front first, at the start of buffer; if a
+		 * move throws the ones already constructed are destroyed
+		 */
+		void move_to(pointer buffer) {
+			size_type moved = 0;
+			try {
+				for (; moved < m_size; ++moved)
+					Alloc_traits::construct(m_allocator, &buffer[moved], std::move_if_noexcept((*this)[moved]));
+			} catch (...) {
+				while (moved > 0)
+					Alloc_traits::destroy(m_allocator, &buffer[--moved]);
+				throw;
+			}
+		}
+
+		/**
+		 * destroys the elements and replaces the array by buffer of n slots,
+		 * leaving the buffer empty
+		 */
+		void adopt(pointer buffer, size_type n) {
+			clear();
+			deallocate(m_buffer, m_capacity);
+			m_buffer = buffer;
+			m_capacity = n;
+			m_head = 0;
+		}
+	};
+
+	template <class T, size_t fixed_capacity, class Allocator>
+	bool operator==(const ring_buffer<T, fixed_capacity, Allocator>& lhs, const ring_buffer<T, fixed_capacity, Allocator>& rhs) {
+		return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+	}
+
+	template <class T, size_t fixed_capacity, class Allocator>
+	bool operator!=(const ring_buffer<T, fixed_capacity, Allocator>& lhs, const ring_buffer<T, fixed_capacity, Allocator>& rhs) {
+		return !(lhs == rhs);
+	}
+}
+
+namespace std {
+	template <class T, size_t fixed_capacity, class Allocator>
+	void swap(ds::ring_buffer<T, fixed_capacity, Allocator>& lhs, ds::ring_buffer<T, fixed_capacity, Allocator>& rhs) {
+		lhs.swap(rhs);
+	}
+}
@@ -0,0 +1,138 @@
+/**
+ * Single producer single consumer ring buffer
+ *
+ * Bounded lock-free FIFO for exactly one pushing and one popping thread. The
+ * producer owns the tail index and the consumer the head index, each on its
+ * own cache line, and each side keeps a cached copy of the other's index so it
+ * only touches the shared line when the cached one says the buffer is full or
+ * empty. The capacity is rounded up to a power of two and never changes.
+ */
+#include <stddef.h>
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace ds {
+
+	template <class T, class Allocator = std::allocator<T>>
+	class spsc_ring_buffer {
+
+		typedef std::allocator_traits<Allocator> Alloc_traits;
+
+	public:
+		typedef T value_type;
+		typedef Allocator allocator_type;
+		typedef size_t size_type;
+
+		/**
+		 * holds at least capacity elements
+		 */
+		explicit spsc_ring_buffer(size_type capacity, const allocator_type& alloc = allocator_type())
+			: m_allocator(alloc), m_buffer(), m_mask(round_up(capacity) - 1), m_head(0), m_cached_tail(0),
+			  m_tail(0), m_cached_head(0) {
+			if (capacity == 0) throw std::length_error("ds::spsc_ring_buffer: capacity must not be zero");
+			m_buffer = Alloc_traits::allocate(m_allocator, m_mask + 1);
+		}
+
+		spsc_ring_buffer(const spsc_ring_buffer&) = delete;
+
+		spsc_ring_buffer& operator=(const spsc_ring_buffer&) = delete;
+
+		/**
+		 * must not run concurrently with any other member
+		 */
+		~spsc_ring_buffer() {
+			const size_type tail = m_tail.load(std::memory_order_relaxed);
+			for (size_type head = m_head.load(std::memory_order_relaxed); head != tail; ++head)
+				Alloc_traits::destroy(m_allocator, &m_buffer[head & m_mask]);
+			Alloc_traits::deallocate(m_allocator, m_buffer, m_mask + 1);
+		}
+
+		bool try_push(const T& value) { return try_emplace(value); }
+
+		bool try_push(T&& value) { return try_emplace(std::move(value)); }
+
+		/**
+		 * constructs an element at the back, returns false if the buffer is
+		 * full; may only be called from the producer thread
+		 */
+		template <class... Args>
+		bool try_emplace(Args&&... args) {
+			const size_type tail = m_tail.load(std::memory_order_relaxed);
+			if (tail - m_cached_head > m_mask) {
+				m_cached_head = m_head.load(std::memory_order_acquire);
+				if (tail - m_cached_head > m_mask) return false;
+			}
+			Alloc_traits::construct(m_allocator, &m_buffer[tail & m_mask], std::forward<Args>(args)...);
+			m_tail.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		/**
+		 * moves the front element into out, returns false if the buffer is
+		 * empty; may only be called from the consumer thread
+		 */
+		bool try_pop(T& out) {
+			T* value = front();
+			if (!value) return false;
+			out = std::move(*value);
+			pop();
+			return true;
+		}
+
+		/**
+		 * the front element, or nullptr if the buffer is empty; may only be
+		 * called from the consumer thread
+		 */
+		T* front() {
+			const size_type head = m_head.load(std::memory_order_relaxed);
+			if (head == m_cached_tail) {
+				m_cached_tail = m_tail.load(std::memory_order_acquire);
+				if (head == m_cached_tail) return nullptr;
+			}
+			return &m_buffer[head & m_mask];
+		}
+
+		/**
+		 * removes the front element, which front() must have returned; may only
+		 * be called from the consumer thread
+		 */
+		void pop() {
+			const size_type head = m_head.load(std::memory_order_relaxed);
+			Alloc_traits::destroy(m_allocator, &m_buffer[head & m_mask]);
+			m_head.store(head + 1, std::memory_order_release);
+		}
+
+		/**
+		 * only a snapshot while the other thread is active
+		 */
+		size_type size() const {
+			return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+		}
+
+		bool empty() const { return size() == 0; }
+
+		size_type capacity() const { return m_mask + 1; }
+
+	private:
+		allocator_type m_allocator;
+		T* m_buffer;
+		size_type m_mask;
+
+		// consumer side
+		alignas(64) std::atomic<size_type> m_head;
+		size_type m_cached_tail;
+
+		// producer side
+		alignas(64) std::atomic<size_type> m_tail;
+		size_type m_cached_head;
+
+		static size_type round_up(size_type n) {
+			size_type capacity = 1;
+			while (capacity < n)
+				capacity <<= 1;
+			return capacity;
+		}
+	};
+}
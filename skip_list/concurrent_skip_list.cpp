@@ -0,0 +1,309 @@
+/**
+ * Lock-free skip list
+ *
+ * Concurrent ordered map after Fraser and Herlihy-Shavit. The low bit of a
+ * next pointer marks its node as deleted on that level; erase marks a node top
+ * down and the thread that marks level 0 owns the deletion. Searches unlink
+ * marked nodes they pass. Readers never write and never retry.
+ *
+ * Unlinked nodes are reclaimed through ds::epoch_reclamation. A node is retired
+ * once both its inserter has stopped linking upper levels and its eraser has
+ * unlinked it, whichever happens last.
+ */
+#include "../concurrent/epoch.cpp"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace ds {
+
+	template <typename Key, typename T, typename Compare = std::less<Key>>
+	class concurrent_skip_list {
+	public:
+		typedef Key key_type;
+		typedef T mapped_type;
+		typedef std::pair<const Key, T> value_type;
+		typedef Compare key_compare;
+		typedef size_t size_type;
+
+		static constexpr size_type max_height = 32;
+
+		explicit concurrent_skip_list(const key_compare& comp = key_compare())
+			: m_head(allocate_node(max_height)), m_size(0), m_comp(comp) {}
+
+		concurrent_skip_list(const concurrent_skip_list&) = delete;
+
+		concurrent_skip_list& operator=(const concurrent_skip_list&) = delete;
+
+		/**
+		 * must not run concurrently with any other member
+		 */
+		~concurrent_skip_list() {
+			for (node_type* node = unmarked(m_head->next[0].load(std::memory_order_relaxed)); node;) {
+				node_type* next = unmarked(node->next[0].load(std::memory_order_relaxed));
+				destroy_node(node);
+				node = next;
+			}
+			deallocate_node(m_head);
+		}
+
+		/**
+		 * inserts (key, value) if key is absent, returns whether it did
+		 */
+		template <class K, class... Args>
+		bool try_emplace(K&& key, Args&&... args) {
+			epoch_reclamation::guard guard;
+			node_type* preds[max_height];
+			node_type* succs[max_height];
+			if (search(key, preds, succs)) return false;
+
+			node_type* node = create_node(random_height(), std::forward<K>(key), std::forward<Args>(args)...);
+			const key_type& node_key = node->val_ptr()->first;
+			for (;;) {
+				for (size_type level = 0; level < node->height; ++level)
+					node->next[level].store(to_word(succs[level]), std::memory_order_relaxed);
+				uintptr_t expected = to_word(succs[0]);
+				if (preds[0]->next[0].compare_exchange_strong(expected, to_word(node))) break;
+				if (search(node_key, preds, succs)) {
+					destroy_node(node);
+					return false;
+				}
+			}
+			m_size.fetch_add(1, std::memory_order_relaxed);
+
+			link_upper_levels(node, preds, succs);
+			if (is_marked(node->next[0].load())) search(node_key, preds, succs);
+			release(node);
+			return true;
+		}
+
+		bool insert(const value_type& val) { return try_emplace(val.first, val.second); }
+
+		/**
+		 * removes key, returns false if it was absent or another thread
+		 * removed it first
+		 */
+		bool erase(const key_type& key) {
+			epoch_reclamation::guard guard;
+			node_type* preds[max_height];
+			node_type* succs[max_height];
+			if (!search(key, preds, succs)) return false;
+
+			node_type* node = succs[0];
+			for (size_type level = node->height; level-- > 1;) {
+				uintptr_t next = node->next[level].load();
+				while (!is_marked(next) && !node->next[level].compare_exchange_weak(next, next | 1)) {}
+			}
+			uintptr_t next = node->next[0].load();
+			for (;;) {
+				if (is_marked(next)) return false;
+				if (node->next[0].compare_exchange_weak(next, next | 1)) break;
+			}
+			m_size.fetch_sub(1, std::memory_order_relaxed);
+
+			search(key, preds, succs);
+			release(node);
+			return true;
+		}
+
+		/**
+		 * copies the value stored under key into out, returns false if absent
+		 */
+		bool find(const key_type& key, T& out) const {
+			epoch_reclamation::guard guard;
+			const node_type* node = lower_bound_node(key);
+			if (!node || m_comp(key, node->val_ptr()->first)) return false;
+			out = node->val_ptr()->second;
+			return true;
+		}
+
+		bool contains(const key_type& key) const {
+			epoch_reclamation::guard guard;
+			const node_type* node = lower_bound_node(key);
+			return node && !m_comp(key, node->val_ptr()->first);
+		}
+
+		/**
+		 * Calls f(key, value) in key order for the elements in [first, last).
+		 * Elements inserted or erased during the walk may or may not be seen.
+		 */
+		template <class Function>
+		void for_each(const key_type& first, const key_type& last, Function f) const {
+			epoch_reclamation::guard guard;
+			for (const node_type* node = lower_bound_node(first); node && m_comp(node->val_ptr()->first, last);) {
+				const uintptr_t next = node->next[0].load(std::memory_order_acquire);
+				if (!is_marked(next)) f(node->val_ptr()->first, node->val_ptr()->second);
+				node = unmarked(next);
+			}
+		}
+
+		template <class Function>
+		void for_each(Function f) const {
+			epoch_reclamation::guard guard;
+			for (const node_type* node = unmarked(m_head->next[0].load(std::memory_order_acquire)); node;) {
+				const uintptr_t next = node->next[0].load(std::memory_order_acquire);
+				if (!is_marked(next)) f(node->val_ptr()->first, node->val_ptr()->second);
+				node = unmarked(next);
+			}
+		}
+
+		/**
+		 * only a snapshot while other threads modify the list
+		 */
+		size_type size() const { return m_size.load(std::memory_order_relaxed); }
+
+		bool empty() const { return size() == 0; }
+
+		key_compare key_comp() const { return m_comp; }
+
+	private:
+		struct node_type {
+
+			value_type* val_ptr() { return reinterpret_cast<value_type*>(&value); }
+
+			const value_type* val_ptr() const { return reinterpret_cast<const value_type*>(&value); }
+
+			typename std::aligned_storage<sizeof(value_type), alignof(value_type)>::type value;
+			// the inserter and the eraser each drop one reference, the last one retires the node
+			std::atomic<int> references;
+			size_t height;
+			// height entries, the node is allocated with room for the extra ones
+			std::atomic<uintptr_t> next[1];
+		};
+
+		node_type* m_head;
+		std::atomic<size_type> m_size;
+		key_compare m_comp;
+
+		static uintptr_t to_word(node_type* node) { return reinterpret_cast<uintptr_t>(node); }
+
+		static node_type* unmarked(uintptr_t word) { return reinterpret_cast<node_type*>(word & ~uintptr_t(1)); }
+
+		static bool is_marked(uintptr_t word) { return word & 1; }
+
+		static node_type* allocate_node(size_type height) {
+			void* memory = ::operator new(sizeof(node_type) + (height - 1)*sizeof(std::atomic<uintptr_t>));
+			node_type* node = static_cast<node_type*>(memory);
+			::new (static_cast<void*>(&node->references)) std::atomic<int>(2);
+			node->height = height;
+			for (size_type level = 0; level < height; ++level)
+				::new (static_cast<void*>(&node->next[level])) std::atomic<uintptr_t>(0);
+			return node;
+		}
+
+		static void deallocate_node(node_type* node) { ::operator delete(node); }
+
+		template <class K, class... Args>
+		static node_type* create_node(size_type height, K&& key, Args&&... args) {
+			node_type* node = allocate_node(height);
+			try {
+				::new (static_cast<void*>(node->val_ptr())) value_type(std::piecewise_construct,
+					std::forward_as_tuple(std::forward<K>(key)), std::forward_as_tuple(std::forward<Args>(args)...));
+			} catch (...) {
+				deallocate_node(node);
+				throw;
+			}
+			return node;
+		}
+
+		static void destroy_node(node_type* node) {
+			node->val_ptr()->~value_type();
+			deallocate_node(node);
+		}
+
+		static void release(node_type* node) {
+			if (node->references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+				epoch_reclamation::retire(node, [](void* ptr) { destroy_node(static_cast<node_type*>(ptr)); });
+		}
+
+		/**
+		 * geometric with p = 1/4, two random bits per level
+		 */
+		static size_type random_height() {
+			static thread_local uint64_t seed = 0x9e3779b97f4a7c15 ^ reinterpret_cast<uintptr_t>(&seed);
+			seed ^= seed << 13;
+			seed ^= seed >> 7;
+			seed ^= seed << 17;
+			size_type height = 1;
+			for (uint64_t bits = seed; height < max_height && (bits & 3) == 0; bits >>= 2)
+				++height;
+			return height;
+		}
+
+		/**
+		 * @brief finds the neighbours of key on every level, unlinking marked nodes on the way
+		 * @return true if succs[0] holds key
+		 */
+		bool search(const key_type& key, node_type** preds, node_type** succs) const {
+		retry:
+			node_type* pred = m_head;
+			for (size_type level = max_height; level-- > 0;) {
+				node_type* curr = unmarked(pred->next[level].load(std::memory_order_acquire));
+				while (curr) {
+					const uintptr_t next = curr->next[level].load(std::memory_order_acquire);
+					if (is_marked(next)) {
+						uintptr_t expected = to_word(curr);
+						if (!pred->next[level].compare_exchange_strong(expected, next & ~uintptr_t(1))) goto retry;
+						curr = unmarked(next);
+					} else if (m_comp(curr->val_ptr()->first, key)) {
+						pred = curr;
+						curr = unmarked(next);
+					} else {
+						break;
+					}
+				}
+				preds[level] = pred;
+				succs[level] = curr;
+			}
+			return succs[0] && !m_comp(key, succs[0]->val_ptr()->first);
+		}
+
+		/**
+		 * returns the first unmarked node whose key is not less than key
+		 * without writing to the list
+		 */
+		const node_type* lower_bound_node(const key_type& key) const {
+			const node_type* pred = m_head;
+			const node_type* curr = nullptr;
+			for (size_type level = max_height; level-- > 0;) {
+				curr = unmarked(pred->next[level].load(std::memory_order_acquire));
+				while (curr) {
+					const uintptr_t next = curr->next[level].load(std::memory_order_acquire);
+					if (is_marked(next)) {
+						curr = unmarked(next);
+					} else if (m_comp(curr->val_ptr()->first, key)) {
+						pred = curr;
+						curr = unmarked(next);
+					} else {
+						break;
+					}
+				}
+			}
+			return curr;
+		}
+
+		/**
+		 * links node into levels 1 and up, giving up once it is marked
+		 */
+		void link_upper_levels(node_type* node, node_type** preds, node_type** succs) {
+			const key_type& key = node->val_ptr()->first;
+			for (size_type level = 1; level < node->height; ++level) {
+				for (;;) {
+					uintptr_t next = node->next[level].load();
+					if (is_marked(next)) return;
+					if (unmarked(next) != succs[level]
+					    && !node->next[level].compare_exchange_strong(next, to_word(succs[level])))
+						return;
+					uintptr_t expected = to_word(succs[level]);
+					if (preds[level]->next[level].compare_exchange_strong(expected, to_word(node))) break;
+					if (!search(key, preds, succs) || succs[0] != node) return;
+				}
+			}
+		}
+	};
+}
@@ -0,0 +1,460 @@
+/**
+ * Skip list
+ *
+ * Ordered map made of sorted singly linked lists stacked on top of each other.
+ * Every node is on level 0 and each level above holds about a quarter of the
+ * nodes below it, so searches skip ahead in O(log n) expected steps. A node's
+ * next pointers are allocated inline after it, sized to its height.
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace ds {
+
+	template <typename Value>
+	struct skip_list_node {
+
+		Value* val_ptr() { return reinterpret_cast<Value*>(&value); }
+
+		const Value* val_ptr() const { return reinterpret_cast<const Value*>(&value); }
+
+		typename std::aligned_storage<sizeof(Value), alignof(Value)>::type value;
+		size_t height;
+		// height entries, the node is allocated with room for the extra ones
+		skip_list_node* next[1];
+	};
+
+	template <typename Key, typename T, typename Compare = std::less<Key>,
+	          typename Allocator = std::allocator<std::pair<const Key, T>>>
+	class skip_list {
+
+		typedef std::allocator_traits<Allocator> Alloc_traits;
+		typedef skip_list_node<std::pair<const Key, T>> node_type;
+		typedef typename std::aligned_storage<sizeof(node_type*), alignof(node_type)>::type unit_type;
+		typedef typename Alloc_traits::template rebind_alloc<unit_type> unit_allocator;
+		typedef std::allocator_traits<unit_allocator> unit_traits;
+
+	public:
+		typedef Key key_type;
+		typedef T mapped_type;
+		typedef std::pair<const Key, T> value_type;
+		typedef Compare key_compare;
+		typedef Allocator allocator_type;
+		typedef size_t size_type;
+		typedef ptrdiff_t difference_type;
+		typedef value_type& reference;
+		typedef const value_type& const_reference;
+		typedef typename Alloc_traits::pointer pointer;
+		typedef typename Alloc_traits::const_pointer const_pointer;
+
+		static constexpr size_type max_height = 32;
+
+		template <bool is_const>
+		class basic_iterator {
+		public:
+			typedef std::forward_iterator_tag iterator_category;
+			typedef std::pair<const Key, T> value_type;
+			typedef ptrdiff_t difference_type;
+			typedef typename std::conditional<is_const, const value_type*, value_type*>::type pointer;
+			typedef typename std::conditional<is_const, const value_type&, value_type&>::type reference;
+
+			basic_iterator() : m_node() {}
+
+			explicit basic_iterator(node_type* node) : m_node(node) {}
+
+			template <bool other_const, class = typename std::enable_if<is_const && !other_const>::type>
+			basic_iterator(const basic_iterator<other_const>& other) : m_node(other.m_node) {}
+
+			reference operator*() const { return *m_node->val_ptr(); }
+
+			pointer operator->() const { return m_node->val_ptr(); }
+
+			basic_iterator& operator++() {
+				m_node = m_node->next[0];
+				return *this;
+			}
+
+			basic_iterator operator++(int) {
+				basic_iterator tmp(*this);
+				m_node = m_node->next[0];
+				return tmp;
+			}
+
+			bool operator==(const basic_iterator& rhs) const { return m_node == rhs.m_node; }
+
+			bool operator!=(const basic_iterator& rhs) const { return m_node != rhs.m_node; }
+
+		private:
+			friend class skip_list;
+
+			node_type* m_node;
+		};
+
+		typedef basic_iterator<false> iterator;
+		typedef basic_iterator<true> const_iterator;
+
+		// Constructors, Destructors and Assignment
+
+		skip_list() : skip_list(key_compare()) {}
+
+		explicit skip_list(const key_compare& comp, const allocator_type& alloc = allocator_type())
+			: m_size(), m_height(1), m_seed(0x9e3779b97f4a7c15), m_comp(comp), m_allocator(alloc) {
+			m_head = allocate_node(max_height);
+		}
+
+		explicit skip_list(const allocator_type& alloc) : skip_list(key_compare(), alloc) {}
+
+		template <class InputIterator, class = typename std::iterator_traits<InputIterator>::iterator_category>
+		skip_list(InputIterator first, InputIterator last, const key_compare& comp = key_compare(),
+		          const allocator_type& alloc = allocator_type())
+			: skip_list(comp, alloc) {
+			insert(first, last);
+		}
+
+		skip_list(std::initializer_list<value_type> il, const key_compare& comp = key_compare(),
+		          const allocator_type& alloc = allocator_type())
+			: skip_list(il.begin(), il.end(), comp, alloc) {}
+
+		skip_list(const skip_list& other)
+			: skip_list(other.m_comp, Alloc_traits::select_on_container_copy_construction(other.m_allocator)) {
+			append(other);
+		}
+
+		skip_list(skip_list&& other) : skip_list(other.m_comp, other.m_allocator) { this->swap(other); }
+
+		~skip_list() {
+			clear();
+			deallocate_node(m_head);
+		}
+
+		skip_list& operator=(const skip_list& other) {
+			if (this != &other) {
+				clear();
+				m_comp = other.m_comp;
+				append(other);
+			}
+			return *this;
+		}
+
+		skip_list& operator=(skip_list&& other) {
+			this->swap(other);
+			return *this;
+		}
+
+		skip_list& operator=(std::initializer_list<value_type> il) {
+			clear();
+			insert(il.begin(), il.end());
+			return *this;
+		}
+
+		allocator_type get_allocator() const { return m_allocator; }
+
+		// Element access
+
+		T& at(const key_type& key) {
+			iterator it = find(key);
+			if (it == end()) throw std::out_of_range("ds::skip_list::at");
+			return it->second;
+		}
+
+		const T& at(const key_type& key) const {
+			const_iterator it = find(key);
+			if (it == end()) throw std::out_of_range("ds::skip_list::at");
+			return it->second;
+		}
+
+		T& operator[](const key_type& key) { return try_emplace(key).first->second; }
+
+		T& operator[](key_type&& key) { return try_emplace(std::move(key)).first->second; }
+
+		// Iterators
+
+		iterator begin() { return iterator(m_head->next[0]); }
+
+		const_iterator begin() const { return const_iterator(m_head->next[0]); }
+
+		const_iterator cbegin() const { return begin(); }
+
+		iterator end() { return iterator(); }
+
+		const_iterator end() const { return const_iterator(); }
+
+		const_iterator cend() const { return const_iterator(); }
+
+		// Capacity
+
+		bool empty() const { return m_size == 0; }
+
+		size_type size() const { return m_size; }
+
+		size_type max_size() const { return unit_traits::max_size(unit_allocator(m_allocator)); }
+
+		// Modifiers
+
+		void clear() {
+			for (node_type* node = m_head->next[0]; node;) {
+				node_type* next = node->next[0];
+				destroy_node(node);
+				node = next;
+			}
+			std::fill(m_head->next, m_head->next + max_height, nullptr);
+			m_size = 0;
+			m_height = 1;
+		}
+
+		std::pair<iterator, bool> insert(const value_type& val) { return try_emplace(val.first, val.second); }
+
+		std::pair<iterator, bool> insert(value_type&& val) { return emplace(std::move(val)); }
+
+		template <class InputIterator, class = typename std::iterator_traits<InputIterator>::iterator_category>
+		void insert(InputIterator first, InputIterator last) {
+			for (; first != last; ++first)
+				emplace(*first);
+		}
+
+		void insert(std::initializer_list<value_type> il) { insert(il.begin(), il.end()); }
+
+		/**
+		 * constructs the element first, then discards it if the key exists
+		 */
+		template <class... Args>
+		std::pair<iterator, bool> emplace(Args&&... args) {
+			node_type* node = create_node(random_height(), std::forward<Args>(args)...);
+			node_type* update[max_height];
+			node_type* next = find_predecessors(node->val_ptr()->first, update);
+			if (next && !m_comp(node->val_ptr()->first, next->val_ptr()->first)) {
+				destroy_node(node);
+				return std::make_pair(iterator(next), false);
+			}
+			link(node, update);
+			return std::make_pair(iterator(node), true);
+		}
+
+		/**
+		 * constructs the mapped value from args only if the key is absent
+		 */
+		template <class K, class... Args>
+		std::pair<iterator, bool> try_emplace(K&& key, Args&&... args) {
+			node_type* update[max_height];
+			node_type* next = find_predecessors(key, update);
+			if (next && !m_comp(key, next->val_ptr()->first)) return std::make_pair(iterator(next), false);
+
+			node_type* node = create_node(random_height(), std::piecewise_construct,
+			                              std::forward_as_tuple(std::forward<K>(key)),
+			                              std::forward_as_tuple(std::forward<Args>(args)...));
+			link(node, update);
+			return std::make_pair(iterator(node), true);
+		}
+
+		template <class M>
+		std::pair<iterator, bool> insert_or_assign(const key_type& key, M&& obj) {
+			std::pair<iterator, bool> result = try_emplace(key, std::forward<M>(obj));
+			if (!result.second) result.first->second = std::forward<M>(obj);
+			return result;
+		}
+
+		iterator erase(const_iterator pos) {
+			node_type* next = pos.m_node->next[0];
+			erase(pos->first);
+			return iterator(next);
+		}
+
+		iterator erase(const_iterator first, const_iterator last) {
+			while (first != last)
+				first = erase(first);
+			return iterator(last.m_node);
+		}
+
+		size_type erase(const key_type& key) {
+			node_type* update[max_height];
+			node_type* node = find_predecessors(key, update);
+			if (!node || m_comp(key, node->val_ptr()->first)) return 0;
+
+			for (size_type level = 0; level < node->height; ++level)
+				update[level]->next[level] = node->next[level];
+			while (m_height > 1 && !m_head->next[m_height - 1])
+				--m_height;
+			destroy_node(node);
+			--m_size;
+			return 1;
+		}
+
+		void swap(skip_list& other) {
+			std::swap(m_head, other.m_head);
+			std::swap(m_size, other.m_size);
+			std::swap(m_height, other.m_height);
+			std::swap(m_seed, other.m_seed);
+			std::swap(m_comp, other.m_comp);
+			std::swap(m_allocator, other.m_allocator);
+		}
+
+		// Lookup
+
+		size_type count(const key_type& key) const { return find(key) != end(); }
+
+		bool contains(const key_type& key) const { return find(key) != end(); }
+
+		iterator find(const key_type& key) {
+			node_type* node = lower_bound_node(key);
+			return iterator(node && !m_comp(key, node->val_ptr()->first) ? node : nullptr);
+		}
+
+		const_iterator find(const key_type& key) const { return const_cast<skip_list&>(*this).find(key); }
+
+		/**
+		 * returns the first element whose key is not less than key
+		 */
+		iterator lower_bound(const key_type& key) { return iterator(lower_bound_node(key)); }
+
+		const_iterator lower_bound(const key_type& key) const { return const_iterator(lower_bound_node(key)); }
+
+		/**
+		 * returns the first element whose key is greater than key
+		 */
+		iterator upper_bound(const key_type& key) { return iterator(upper_bound_node(key)); }
+
+		const_iterator upper_bound(const key_type& key) const { return const_iterator(upper_bound_node(key)); }
+
+		std::pair<iterator, iterator> equal_range(const key_type& key) {
+			return std::make_pair(lower_bound(key), upper_bound(key));
+		}
+
+		std::pair<const_iterator, const_iterator> equal_range(const key_type& key) const {
+			return std::make_pair(lower_bound(key), upper_bound(key));
+		}
+
+		// Observers
+
+		key_compare key_comp() const { return m_comp; }
+
+	private:
+		node_type* m_head;
+		size_type m_size;
+		size_type m_height;
+		uint64_t m_seed;
+		key_compare m_comp;
+		allocator_type m_allocator;
+
+		static size_type node_units(size_type height) {
+			return (sizeof(node_type) + (height - 1)*sizeof(node_type*) + sizeof(unit_type) - 1)/sizeof(unit_type);
+		}
+
+		node_type* allocate_node(size_type height) {
+			unit_allocator alloc(m_allocator);
+			node_type* node = reinterpret_cast<node_type*>(std::addressof(*unit_traits::allocate(alloc, node_units(height))));
+			node->height = height;
+			std::fill(node->next, node->next + height, nullptr);
+			return node;
+		}
+
+		void deallocate_node(node_type* node) {
+			unit_allocator alloc(m_allocator);
+			unit_traits::deallocate(alloc, reinterpret_cast<unit_type*>(node), node_units(node->height));
+		}
+
+		template <class... Args>
+		node_type* create_node(size_type height, Args&&... args) {
+			node_type* node = allocate_node(height);
+			try {
+				Alloc_traits::construct(m_allocator, node->val_ptr(), std::forward<Args>(args)...);
+			} catch (...) {
+				deallocate_node(node);
+				throw;
+			}
+			return node;
+		}
+
+		void destroy_node(node_type* node) {
+			Alloc_traits::destroy(m_allocator, node->val_ptr());
+			deallocate_node(node);
+		}
+
+		/**
+		 * geometric with p = 1/4, two random bits per level
+		 */
+		size_type random_height() {
+			m_seed ^= m_seed << 13;
+			m_seed ^= m_seed >> 7;
+			m_seed ^= m_seed << 17;
+			size_type height = 1;
+			for (uint64_t bits = m_seed; height < max_height && (bits & 3) == 0; bits >>= 2)
+				++height;
+			return height;
+		}
+
+		/**
+		 * @brief descends from the top level, stepping right while before(key) holds
+		 * @return the first node on level 0 for which before does not hold
+		 */
+		template <class Before>
+		node_type* descend(Before before, node_type** update) const {
+			node_type* node = m_head;
+			for (size_type level = m_height; level-- > 0;) {
+				while (node->next[level] && before(node->next[level]->val_ptr()->first))
+					node = node->next[level];
+				if (update) update[level] = node;
+			}
+			return node->next[0];
+		}
+
+		node_type* find_predecessors(const key_type& key, node_type** update) const {
+			for (size_type level = m_height; level < max_height; ++level)
+				update[level] = m_head;
+			return descend([&](const key_type& x) { return m_comp(x, key); }, update);
+		}
+
+		node_type* lower_bound_node(const key_type& key) const {
+			return descend([&](const key_type& x) { return m_comp(x, key); }, nullptr);
+		}
+
+		node_type* upper_bound_node(const key_type& key) const {
+			return descend([&](const key_type& x) { return !m_comp(key, x); }, nullptr);
+		}
+
+		void link(node_type* node, node_type** update) {
+			for (size_type level = 0; level < node->height; ++level) {
+				node->next[level] = update[level]->next[level];
+				update[level]->next[level] = node;
+			}
+			m_height = std::max(m_height, node->height);
+			++m_size;
+		}
+
+		/**
+		 * copies the sorted elements of other to the back without searching
+		 */
+		void append(const skip_list& other) {
+			node_type* tails[max_height];
+			std::fill(tails, tails + max_height, m_head);
+			for (const value_type& val : other) {
+				node_type* node = create_node(random_height(), val);
+				link(node, tails);
+				std::fill(tails, tails + node->height, node);
+			}
+		}
+	};
+
+	template <class Key, class T, class Compare, class Alloc>
+	bool operator==(const skip_list<Key, T, Compare, Alloc>& lhs, const skip_list<Key, T, Compare, Alloc>& rhs) {
+		return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+	}
+
+	template <class Key, class T, class Compare, class Alloc>
+	bool operator!=(const skip_list<Key, T, Compare, Alloc>& lhs, const skip_list<Key, T, Compare, Alloc>& rhs) {
+		return !(lhs == rhs);
+	}
+}
+
+namespace std {
+	template <class Key, class T, class Compare, class Alloc>
+	void swap(ds::skip_list<Key, T, Compare, Alloc>& lhs, ds::skip_list<Key, T, Compare, Alloc>& rhs) { lhs.swap(rhs); }
+}
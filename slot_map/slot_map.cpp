@@ -0,0 +1,260 @@
+/**
+ * Slot map
+ *
+ * Stores objects contiguously in a Vector and hands out handles that stay
+ * valid until their object is erased, however many other objects are
+ * inserted or erased in between.
+ *
+ * A handle names a slot and the slot's generation. The slot holds the
+ * object's current position in the dense Vector; erasing moves the last
+ * object into the gap, updates that object's slot and bumps the erased
+ * slot's generation, so a stale handle no longer matches. Free slots form
+ * a linked list through their position fields and are reused first.
+ *
+ * Insert, erase and lookup are O(1), iteration walks the dense objects.
+ * Erasing changes the order of the remaining objects.
+ */
+#include "../vector/Vector.cpp"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace ds {
+
+	/**
+	 * handle to an object of a slot_map; default constructed it refers to
+	 * nothing
+	 */
+	struct slot_handle {
+		static constexpr uint32_t no_slot = UINT32_MAX;
+
+		uint32_t slot = no_slot;
+		uint32_t generation = 0;
+
+		bool operator==(const slot_handle& rhs) const { return slot == rhs.slot && generation == rhs.generation; }
+
+		bool operator!=(const slot_handle& rhs) const { return !(*this == rhs); }
+	};
+
+	template <class T, class Allocator = std::allocator<T>>
+	class slot_map {
+	public:
+		typedef T value_type;
+		typedef slot_handle handle;
+		typedef Vector<T, 2, Allocator> container_type;
+		typedef typename container_type::size_type size_type;
+		typedef typename container_type::difference_type difference_type;
+		typedef T& reference;
+		typedef const T& const_reference;
+		typedef T* pointer;
+		typedef const T* const_pointer;
+		typedef typename container_type::iterator iterator;
+		typedef typename container_type::const_iterator const_iterator;
+
+		// Constructors
+
+		slot_map() : m_free(slot_handle::no_slot) {}
+
+		// Iterators
+
+		iterator begin() { return m_values.begin(); }
+
+		const_iterator begin() const { return m_values.begin(); }
+
+		const_iterator cbegin() const { return m_values.cbegin(); }
+
+		iterator end() { return m_values.end(); }
+
+		const_iterator end() const { return m_values.end(); }
+
+		const_iterator cend() const { return m_values.cend(); }
+
+		// Capacity
+
+		size_type size() const { return m_values.size(); }
+
+		bool empty() const { return m_values.empty(); }
+
+		size_type capacity() const { return m_values.capacity(); }
+
+		void reserve(size_type n) {
+			m_values.reserve(n);
+			m_owners.reserve(n);
+			m_slots.reserve(n);
+		}
+
+		// Lookup
+
+		/**
+		 * the object of h, or nullptr if it was erased
+		 */
+		pointer find(handle h) {
+			return contains(h) ? &m_values[m_slots[h.slot].position] : nullptr;
+		}
+
+		const_pointer find(handle h) const {
+			return contains(h) ? &m_values[m_slots[h.slot].position] : nullptr;
+		}
+
+		bool contains(handle h) const {
+			return h.slot < m_slots.size() && m_slots[h.slot].generation == h.generation;
+		}
+
+		/**
+		 * the object of h, which must be valid
+		 */
+		reference operator[](handle h) { return m_values[m_slots[h.slot].position]; }
+
+		const_reference operator[](handle h) const { return m_values[m_slots[h.slot].position]; }
+
+		/**
+		 * @throws std::out_of_range if h was erased
+		 */
+		reference at(handle h) {
+			if (!contains(h)) throw std::out_of_range("ds::slot_map::at");
+			return (*this)[h];
+		}
+
+		const_reference at(handle h) const {
+			if (!contains(h)) throw std::out_of_range("ds::slot_map::at");
+			return (*this)[h];
+		}
+
+		/**
+		 * the handle of the object at it
+		 */
+		handle handle_of(const_iterator it) const {
+			const uint32_t slot = m_owners[it - m_values.cbegin()];
+			return handle{slot, m_slots[slot].generation};
+		}
+
+		/**
+		 * the objects, contiguous
+		 */
+		pointer data() { return m_values.data(); }
+
+		const_pointer data() const { return m_values.data(); }
+
+		// Modifiers
+
+		handle insert(const T& value) { return emplace(value); }
+
+		handle insert(T&& value) { return emplace(std::move(value)); }
+
+		template <class... Args>
+		handle emplace(Args&&... args) {
+			if (m_values.size() == slot_handle::no_slot) throw std::length_error("ds::slot_map: too many objects");
+
+			uint32_t slot = m_free;
+			const bool new_slot = slot == slot_handle::no_slot;
+			if (new_slot) {
+				slot = static_cast<uint32_t>(m_slots.size());
+				m_slots.push_back(slot_entry{0, 0});
+			}
+			// the bookkeeping grows first and is rolled back if the object
+			// cannot be made, so a throw leaves no object without a slot
+			try {
+				m_owners.push_back(slot);
+				m_values.emplace_back(std::forward<Args>(args)...);
+			} catch (...) {
+				if (m_owners.size() > m_values.size()) m_owners.pop_back();
+				if (new_slot) m_slots.pop_back();
+				throw;
+			}
+			if (!new_slot) m_free = m_slots[slot].position;
+			m_slots[slot].position = static_cast<uint32_t>(m_values.size() - 1);
+			return handle{slot, m_slots[slot].generation};
+		}
+
+		/**
+		 * @brief erases the object of h
+		 * @return false if h was already erased
+		 */
+		bool erase(handle h) {
+			if (!contains(h)) return false;
+			erase_at(m_slots[h.slot].position);
+			return true;
+		}
+
+		/**
+		 * @brief erases the object at pos
+		 * @return an iterator to the object moved into its place, or end()
+		 */
+		iterator erase(const_iterator pos) {
+			const size_type position = pos - m_values.cbegin();
+			erase_at(position);
+			return m_values.begin() + position;
+		}
+
+		/**
+		 * erases every object; all handles become invalid
+		 */
+		void clear() {
+			for (uint32_t slot : m_owners)
+				release(slot);
+			m_values.clear();
+			m_owners.clear();
+		}
+
+		void swap(slot_map& other) {
+			m_values.swap(other.m_values);
+			m_owners.swap(other.m_owners);
+			m_slots.swap(other.m_slots);
+			std::swap(m_free, other.m_free);
+		}
+
+	private:
+		struct slot_entry {
+			// position in m_values, or the next free slot
+			uint32_t position;
+			uint32_t generation;
+		};
+
+		container_type m_values;
+		// the slot of each object in m_values
+		Vector<uint32_t> m_owners;
+		Vector<slot_entry> m_slots;
+		// head of the free slot list
+		uint32_t m_free;
+
+		void erase_at(size_type position) {
+			const uint32_t slot = m_owners[position];
+			const size_type last = m_values.size() - 1;
+			if (position != last) {
+				m_values[position] = std::move(m_values[last]);
+				m_owners[position] = m_owners[last];
+				m_slots[m_owners[position]].position = static_cast<uint32_t>(position);
+			}
+			m_values.pop_back();
+			m_owners.pop_back();
+			release(slot);
+		}
+
+		/**
+		 * invalidates the handles of slot and puts it on the free list
+		 */
+		void release(uint32_t slot) {
+			++m_slots[slot].generation;
+			m_slots[slot].position = m_free;
+			m_free = slot;
+		}
+	};
+}
+
+namespace std {
+	template <>
+	struct hash<ds::slot_handle> {
+		size_t operator()(const ds::slot_handle& h) const {
+			return std::hash<uint64_t>()(uint64_t(h.generation) << 32 | h.slot);
+		}
+	};
+
+	template <class T, class Allocator>
+	void swap(ds::slot_map<T, Allocator>& lhs, ds::slot_map<T, Allocator>& rhs) {
+		lhs.swap(rhs);
+	}
+}
@@ -0,0 +1,289 @@
+/**
+ * Double array trie
+ *
+ * Static trie stored as a single array of (base, check) pairs. The transition
+ * from state s on digit d goes to t = base[s] + code(d) and is valid when
+ * check[t] == s, so every digit costs exactly one array lookup. Keys are
+ * terminated by code 0, whose unit stores the index of the value in base.
+ */
+ #include "trie.cpp"
+
+ #include <algorithm>
+ #include <cstdint>
+ #include <iterator>
+ #include <stdexcept>
+ #include <type_traits>
+ #include <utility>
+ #include <vector>
+
+namespace ds {
+
+	template <class Key, class T>
+	class double_array_trie {
+	public:
+		typedef typename Key::value_type digit_type;
+		typedef T value_type;
+		typedef size_t size_type;
+
+		static_assert(sizeof(digit_type) <= 2, "ds::double_array_trie: digits must be at most 16 bits");
+
+		double_array_trie() : m_units(1, unit{0, root_check}) {}
+
+		/**
+		 * Builds the trie from a range of (key, value) pairs. The range does not
+		 * need to be sorted, for duplicate keys the last value is kept.
+		 */
+		template <class InputIterator>
+		double_array_trie(InputIterator first, InputIterator last) {
+			std::vector<std::pair<Key, T>> entries(first, last);
+			build(entries);
+		}
+
+		explicit double_array_trie(const trie<Key, T>& source) {
+			std::vector<std::pair<Key, T>> entries;
+			Key key;
+			collect(source.top(), key, entries);
+			build(entries);
+		}
+
+		T& at(const Key& key) {
+			T* val = find(key);
+			if (!val) throw std::out_of_range("ds::double_array_trie::at");
+			return *val;
+		}
+
+		const T& at(const Key& key) const {
+			const T* val = find(key);
+			if (!val) throw std::out_of_range("ds::double_array_trie::at");
+			return *val;
+		}
+
+		/**
+		 * returns a pointer to the value stored under key or nullptr
+		 */
+		T* find(const Key& key) {
+			return const_cast<T*>(static_cast<const double_array_trie&>(*this).find(key));
+		}
+
+		const T* find(const Key& key) const {
+			int32_t state = 0;
+			for (const auto& digit : key)
+				if ((state = transition(state, code(digit))) < 0) return nullptr;
+			return value(state);
+		}
+
+		bool contains(const Key& key) const { return find(key); }
+
+		/**
+		 * Finds the longest key that is a prefix of [first, last). Returns its
+		 * length and value, or (0, nullptr) if no key matches.
+		 */
+		template <class InputIterator>
+		std::pair<size_type, const T*> longest_prefix_match(InputIterator first, InputIterator last) const {
+			std::pair<size_type, const T*> match(0, value(0));
+			int32_t state = 0;
+			for (size_type length = 1; first != last; ++first, ++length) {
+				if ((state = transition(state, code(*first))) < 0) break;
+				if (const T* val = value(state)) match = std::make_pair(length, val);
+			}
+			return match;
+		}
+
+		std::pair<size_type, const T*> longest_prefix_match(const Key& text) const {
+			return longest_prefix_match(text.begin(), text.end());
+		}
+
+		bool empty() const { return m_values.empty(); }
+
+		size_type size() const { return m_values.size(); }
+
+		/**
+		 * number of (base, check) units in the array
+		 */
+		size_type units() const { return m_units.size(); }
+
+		void clear() {
+			m_units.assign(1, unit{0, root_check});
+			m_values.clear();
+		}
+
+		void swap(double_array_trie& other) {
+			std::swap(m_units, other.m_units);
+			std::swap(m_values, other.m_values);
+		}
+
+	private:
+		// base and check are interleaved so a transition touches one cache line
+		struct unit {
+			int32_t base;
+			int32_t check;
+		};
+
+		static constexpr int32_t free_check = -1;
+		static constexpr int32_t root_check = -2;
+
+		std::vector<unit> m_units;
+		std::vector<T> m_values;
+
+		static uint32_t code(digit_type digit) {
+			return static_cast<uint32_t>(static_cast<typename std::make_unsigned<digit_type>::type>(digit)) + 1;
+		}
+
+		int32_t transition(int32_t state, uint32_t c) const {
+			const uint32_t next = static_cast<uint32_t>(m_units[state].base) + c;
+			if (next >= m_units.size() || m_units[next].check != state) return -1;
+			return next;
+		}
+
+		const T* value(int32_t state) const {
+			const int32_t leaf = transition(state, 0);
+			return leaf < 0 ? nullptr : &m_values[m_units[leaf].base];
+		}
+
+		static void collect(const typename trie<Key, T>::node_type* node, Key& key, std::vector<std::pair<Key, T>>& entries) {
+			if (node->val) entries.emplace_back(key, *node->val);
+			for (auto* child = node->child; child; child = child->next) {
+				key.push_back(*child->digit);
+				collect(child, key, entries);
+				key.pop_back();
+			}
+		}
+
+		/**
+		 * Places the sorted keys into the array. Free cells are kept in a
+		 * circular doubly linked list so finding a base only visits free cells.
+		 */
+		class builder {
+		public:
+			builder(std::vector<unit>& units, const std::vector<std::pair<Key, T>>& entries)
+				: m_units(units), m_entries(entries) {}
+
+			void build() {
+				m_units.assign(1, unit{0, root_check});
+				m_next.assign(1, 0);
+				m_prev.assign(1, 0);
+				m_head = -1;
+				if (!m_entries.empty()) place(0, 0, m_entries.size(), 0);
+				m_units.resize(m_size);
+			}
+
+		private:
+			struct edge {
+				uint32_t code;
+				size_t first, last;
+			};
+
+			std::vector<unit>& m_units;
+			const std::vector<std::pair<Key, T>>& m_entries;
+			std::vector<int32_t> m_next, m_prev;
+			int32_t m_head;
+			size_t m_size = 1;
+
+			void grow(size_t size) {
+				const size_t old_size = m_units.size();
+				if (size <= old_size) return;
+				size = std::max(size, 2*old_size);
+				m_units.resize(size, unit{0, free_check});
+				m_next.resize(size);
+				m_prev.resize(size);
+				for (size_t cell = old_size; cell < size; ++cell) {
+					if (m_head < 0) {
+						m_head = m_next[cell] = m_prev[cell] = cell;
+					} else {
+						const int32_t tail = m_prev[m_head];
+						m_next[tail] = cell;
+						m_prev[cell] = tail;
+						m_next[cell] = m_head;
+						m_prev[m_head] = cell;
+					}
+				}
+			}
+
+			void occupy(int32_t cell, int32_t parent) {
+				m_units[cell].check = parent;
+				m_size = std::max<size_t>(m_size, cell + 1);
+				if (m_next[cell] == cell) {
+					m_head = -1;
+					return;
+				}
+				m_next[m_prev[cell]] = m_next[cell];
+				m_prev[m_next[cell]] = m_prev[cell];
+				if (m_head == cell) m_head = m_next[cell];
+			}
+
+			int32_t find_base(const std::vector<edge>& edges) {
+				if (m_head < 0) grow(m_units.size() + 1);
+				for (int32_t cell = m_head;;) {
+					const int32_t base = cell - static_cast<int32_t>(edges.front().code);
+					if (base >= 0) {
+						grow(base + edges.back().code + 1);
+						bool fits = true;
+						for (const edge& e : edges)
+							if (m_units[base + e.code].check != free_check) { fits = false; break; }
+						if (fits) return base;
+					}
+
+					cell = m_next[cell];
+					if (cell == m_head) {
+						const size_t old_size = m_units.size();
+						grow(old_size + 1);
+						cell = old_size;
+					}
+				}
+			}
+
+			void place(int32_t state, size_t first, size_t last, size_t depth) {
+				std::vector<edge> edges;
+				for (size_t i = first; i < last;) {
+					const Key& key = m_entries[i].first;
+					const uint32_t c = key.size() > depth ? code(*std::next(key.begin(), depth)) : 0;
+					size_t j = i + 1;
+					if (c) {
+						while (j < last && m_entries[j].first.size() > depth
+						       && code(*std::next(m_entries[j].first.begin(), depth)) == c)
+							++j;
+					}
+					edges.push_back(edge{c, i, j});
+					i = j;
+				}
+
+				const int32_t base = find_base(edges);
+				m_units[state].base = base;
+				for (const edge& e : edges)
+					occupy(base + e.code, state);
+
+				for (const edge& e : edges) {
+					if (e.code) place(base + e.code, e.first, e.last, depth + 1);
+					else m_units[base].base = e.first;
+				}
+			}
+		};
+
+		void build(std::vector<std::pair<Key, T>>& entries) {
+			std::stable_sort(entries.begin(), entries.end(), [](const std::pair<Key, T>& lhs, const std::pair<Key, T>& rhs) {
+				return std::lexicographical_compare(lhs.first.begin(), lhs.first.end(), rhs.first.begin(), rhs.first.end(),
+					[](digit_type a, digit_type b) { return code(a) < code(b); });
+			});
+
+			// keep the last value given for each key
+			size_t size = 0;
+			for (size_t i = 0; i < entries.size(); ++i) {
+				if (size && entries[size-1].first == entries[i].first) entries[size-1] = std::move(entries[i]);
+				else if (size++ != i) entries[size-1] = std::move(entries[i]);
+			}
+			entries.erase(entries.begin() + size, entries.end());
+
+			builder(m_units, entries).build();
+
+			m_values.clear();
+			m_values.reserve(entries.size());
+			for (auto& entry : entries)
+				m_values.push_back(std::move(entry.second));
+		}
+	};
+}
+
+namespace std {
+	template <class Key, class T>
+	void swap(ds::double_array_trie<Key, T>& lhs, ds::double_array_trie<Key, T>& rhs) { lhs.swap(rhs); }
+}
@@ -3,7 +3,9 @@
  */
  #include <utility>
  #include <functional>
+ #include <iterator>
  #include <stdexcept>
+ #include <vector>
 
 namespace ds {
 
@@ -15,6 +17,24 @@ namespace ds {
 		Node<T>* r_child = nullptr;
 	};
 
+	/**
+	 * Shape and memory usage of a hash trie, as returned by hash_trie::stats.
+	 * Byte counts cover the nodes and values owned by the trie but not the
+	 * bookkeeping of the underlying allocator.
+	 */
+	struct hash_trie_stats {
+		size_t node_count = 0;
+		size_t key_count = 0;
+		// depth_histogram[d] is the number of nodes d bits below the root
+		std::vector<size_t> depth_histogram;
+		// fanout_histogram[n] is the number of nodes with n children
+		std::vector<size_t> fanout_histogram = std::vector<size_t>(3);
+		size_t bytes_allocated = 0;
+		// bytes spent on values, the rest is structure
+		size_t payload_bytes = 0;
+		double wasted_bytes_per_key = 0;
+	};
+
 	template <class Key, class T>
 	class hash_trie {
 	public:
@@ -110,12 +130,87 @@ namespace ds {
 			return current;
 		}
 
+		hash_trie_stats stats() const {
+			hash_trie_stats result;
+			collect_stats(&m_root, 0, result);
+
+			// the root is embedded in the hash trie
+			result.bytes_allocated -= sizeof(node_type);
+			result.payload_bytes = result.key_count*sizeof(T);
+			if (result.key_count)
+				result.wasted_bytes_per_key = double(result.bytes_allocated - result.payload_bytes)/result.key_count;
+			return result;
+		}
+
+		/**
+		 * Looks up every key in keys and writes the result of find for the i-th
+		 * key to out[i]. Up to batch_lanes lookups walk the trie in lockstep,
+		 * each prefetching its next node before yielding to the others.
+		 */
+		template <class Keys, class RandomAccessIterator>
+		void find_batch(const Keys& keys, RandomAccessIterator out) {
+			struct lane {
+				size_t index;
+				size_t hashed;
+				node_type* node;
+			};
+
+			lane lanes[batch_lanes];
+			size_t active = 0, index = 0;
+			auto next_key = std::begin(keys);
+
+			auto start = [&](lane& l) {
+				if (next_key == std::end(keys)) return false;
+				l.index = index++;
+				l.hashed = std::hash<Key>{}(*next_key++);
+				l.node = &m_root;
+				return true;
+			};
+
+			while (active < batch_lanes && start(lanes[active]))
+				++active;
+
+			while (active) {
+				for (size_t i = 0; i < active;) {
+					lane& l = lanes[i];
+					if (l.hashed && l.node) {
+						l.node = (l.hashed&1) ? l.node->r_child : l.node->l_child;
+						l.hashed >>= 1;
+						if (l.node) __builtin_prefetch(l.node);
+						++i;
+						continue;
+					}
+
+					out[l.index] = l.node;
+					if (!start(l)) l = lanes[--active];
+				}
+			}
+		}
+
 		~hash_trie() { clear(); }
 
 	private:
+		static constexpr size_t batch_lanes = 16;
+
 		node_type m_root;
 		size_t m_size;
 
+		void collect_stats(const node_type* node, size_t depth, hash_trie_stats& result) const {
+			if (node->l_child) collect_stats(node->l_child, depth+1, result);
+			if (node->r_child) collect_stats(node->r_child, depth+1, result);
+
+			++result.node_count;
+			result.bytes_allocated += sizeof(node_type);
+			if (node->val) {
+				++result.key_count;
+				result.bytes_allocated += sizeof(T);
+			}
+
+			if (result.depth_histogram.size() <= depth) result.depth_histogram.resize(depth+1);
+			++result.depth_histogram[depth];
+			++result.fanout_histogram[bool(node->l_child) + bool(node->r_child)];
+		}
+
 		void destroy(node_type* root) {
 			if (!root) return;
 			destroy(root->l_child);
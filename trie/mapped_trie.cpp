@@ -0,0 +1,450 @@
+/**
+ * Immutable memory mapped trie
+ *
+ * A trie is frozen into a LOUDS (level order unary degree sequence) encoding:
+ * every node, in breadth first order, writes one 1 bit per child followed by a
+ * 0 bit. The k-th 1 bit is the edge to node k+1, so the children of node i are
+ * found with a single select0 and stored in a contiguous run of labels.
+ *
+ * File layout (all sections 8 byte aligned):
+ *   header | louds bits | louds rank | labels | terminal bits | terminal rank | values
+ */
+ #include "trie.cpp"
+
+ #include <algorithm>
+ #include <cerrno>
+ #include <cstdint>
+ #include <cstring>
+ #include <fstream>
+ #include <stdexcept>
+ #include <string>
+ #include <system_error>
+ #include <type_traits>
+ #include <utility>
+ #include <vector>
+
+ #include <fcntl.h>
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+ #include <unistd.h>
+
+namespace ds {
+
+	struct mapped_trie_header {
+		char magic[8];
+		uint64_t digit_size;
+		uint64_t value_size;
+		uint64_t node_count;
+		uint64_t key_count;
+		uint64_t louds_offset;
+		uint64_t louds_rank_offset;
+		uint64_t labels_offset;
+		uint64_t terminal_offset;
+		uint64_t terminal_rank_offset;
+		uint64_t values_offset;
+		uint64_t file_size;
+	};
+
+	constexpr char mapped_trie_magic[8] = {'d', 's', 't', 'r', 'i', 'e', 0, 1};
+
+	// number of 64 bit words covered by each rank sample
+	constexpr size_t mapped_trie_block_words = 8;
+
+	/**
+	 * read only view of a bit array with a rank directory of one sample every
+	 * mapped_trie_block_words words
+	 */
+	class louds_bits {
+	public:
+		louds_bits() = default;
+
+		louds_bits(const uint64_t* words, const uint64_t* ranks, size_t size)
+			: m_words(words), m_ranks(ranks), m_size(size) {}
+
+		bool operator[](size_t pos) const { return (m_words[pos/64] >> (pos%64)) & 1; }
+
+		size_t size() const { return m_size; }
+
+		/**
+		 * number of set bits in [0, pos)
+		 */
+		size_t rank1(size_t pos) const {
+			const size_t word = pos/64;
+			size_t rank = m_ranks[word/mapped_trie_block_words];
+			for (size_t i = word - word%mapped_trie_block_words; i < word; ++i)
+				rank += __builtin_popcountll(m_words[i]);
+			if (pos%64) rank += __builtin_popcountll(m_words[word] << (64 - pos%64));
+			return rank;
+		}
+
+		/**
+		 * position of the n-th (zero based) clear bit
+		 */
+		size_t select0(size_t n) const {
+			const size_t blocks = (m_size + 64*mapped_trie_block_words - 1)/(64*mapped_trie_block_words);
+			size_t lo = 0, hi = blocks;
+			while (hi - lo > 1) {
+				const size_t mid = (lo + hi)/2;
+				if (zeros_before_block(mid) <= n) lo = mid;
+				else hi = mid;
+			}
+
+			n -= zeros_before_block(lo);
+			for (size_t word = lo*mapped_trie_block_words;; ++word) {
+				uint64_t zeros = ~m_words[word];
+				const size_t count = __builtin_popcountll(zeros);
+				if (n < count) {
+					for (; n; --n) zeros &= zeros - 1;
+					return word*64 + __builtin_ctzll(zeros);
+				}
+				n -= count;
+			}
+		}
+
+		/**
+		 * position of the first clear bit at or after pos
+		 */
+		size_t next0(size_t pos) const {
+			size_t word = pos/64;
+			uint64_t zeros = ~m_words[word] & (~uint64_t(0) << (pos%64));
+			while (!zeros) zeros = ~m_words[++word];
+			return word*64 + __builtin_ctzll(zeros);
+		}
+
+	private:
+		const uint64_t* m_words = nullptr;
+		const uint64_t* m_ranks = nullptr;
+		size_t m_size = 0;
+
+		size_t zeros_before_block(size_t block) const {
+			return block*64*mapped_trie_block_words - m_ranks[block];
+		}
+	};
+
+	/**
+	 * Writes a LOUDS encoding of the trie to path, which can later be opened
+	 * with ds::mapped_trie. Children are stored sorted by digit, so both the
+	 * digit and value types have to be trivially copyable.
+	 */
+	template <class Key, class T>
+	void freeze(const trie<Key, T>& source, const std::string& path) {
+		typedef typename trie<Key, T>::digit_type digit_type;
+		typedef typename trie<Key, T>::node_type node_type;
+		static_assert(std::is_trivially_copyable<digit_type>::value, "ds::freeze: digits must be trivially copyable");
+		static_assert(std::is_trivially_copyable<T>::value, "ds::freeze: values must be trivially copyable");
+
+		std::vector<const node_type*> order = {source.top()};
+		std::vector<uint64_t> louds, terminal;
+		std::vector<digit_type> labels = {digit_type()};
+		std::vector<T> values;
+		size_t louds_size = 0;
+
+		auto push_bit = [](std::vector<uint64_t>& bits, size_t& size, bool bit) {
+			if (size%64 == 0) bits.push_back(0);
+			if (bit) bits.back() |= uint64_t(1) << (size%64);
+			++size;
+		};
+
+		std::vector<const node_type*> children;
+		for (size_t i = 0, terminal_size = 0; i < order.size(); ++i) {
+			const node_type* node = order[i];
+
+			push_bit(terminal, terminal_size, node->val);
+			if (node->val) values.push_back(*node->val);
+
+			children.clear();
+			for (const node_type* child = node->child; child; child = child->next)
+				children.push_back(child);
+			std::sort(children.begin(), children.end(), [](const node_type* lhs, const node_type* rhs) {
+				return *lhs->digit < *rhs->digit;
+			});
+
+			for (const node_type* child : children) {
+				push_bit(louds, louds_size, true);
+				order.push_back(child);
+				labels.push_back(*child->digit);
+			}
+			push_bit(louds, louds_size, false);
+		}
+
+		// one sample per block holding the number of bits set before it
+		auto rank_directory = [](const std::vector<uint64_t>& bits) {
+			std::vector<uint64_t> ranks;
+			uint64_t rank = 0;
+			for (size_t word = 0; word < bits.size(); ++word) {
+				if (word%mapped_trie_block_words == 0) ranks.push_back(rank);
+				rank += __builtin_popcountll(bits[word]);
+			}
+			return ranks;
+		};
+
+		const std::vector<uint64_t> louds_rank = rank_directory(louds);
+		const std::vector<uint64_t> terminal_rank = rank_directory(terminal);
+
+		auto align = [](uint64_t offset) { return (offset + 7) & ~uint64_t(7); };
+
+		mapped_trie_header header = {};
+		std::memcpy(header.magic, mapped_trie_magic, sizeof(header.magic));
+		header.digit_size           = sizeof(digit_type);
+		header.value_size           = sizeof(T);
+		header.node_count           = order.size();
+		header.key_count            = values.size();
+		header.louds_offset         = align(sizeof(header));
+		header.louds_rank_offset    = align(header.louds_offset + louds.size()*sizeof(uint64_t));
+		header.labels_offset        = align(header.louds_rank_offset + louds_rank.size()*sizeof(uint64_t));
+		header.terminal_offset      = align(header.labels_offset + labels.size()*sizeof(digit_type));
+		header.terminal_rank_offset = align(header.terminal_offset + terminal.size()*sizeof(uint64_t));
+		header.values_offset        = align(header.terminal_rank_offset + terminal_rank.size()*sizeof(uint64_t));
+		header.file_size            = header.values_offset + values.size()*sizeof(T);
+
+		std::ofstream out(path, std::ios::binary | std::ios::trunc);
+		if (!out) throw std::runtime_error("ds::freeze: unable to open " + path);
+
+		uint64_t written = 0;
+		auto write = [&](uint64_t offset, const void* data, size_t bytes) {
+			static const char padding[8] = {};
+			out.write(padding, offset - written);
+			out.write(static_cast<const char*>(data), bytes);
+			written = offset + bytes;
+		};
+
+		write(0, &header, sizeof(header));
+		write(header.louds_offset, louds.data(), louds.size()*sizeof(uint64_t));
+		write(header.louds_rank_offset, louds_rank.data(), louds_rank.size()*sizeof(uint64_t));
+		write(header.labels_offset, labels.data(), labels.size()*sizeof(digit_type));
+		write(header.terminal_offset, terminal.data(), terminal.size()*sizeof(uint64_t));
+		write(header.terminal_rank_offset, terminal_rank.data(), terminal_rank.size()*sizeof(uint64_t));
+		write(header.values_offset, values.data(), values.size()*sizeof(T));
+
+		if (!out.flush()) throw std::runtime_error("ds::freeze: unable to write " + path);
+	}
+
+	/**
+	 * Read only trie answering queries directly from a file written by ds::freeze
+	 */
+	template <class Key, class T>
+	class mapped_trie {
+	public:
+		typedef typename Key::value_type digit_type;
+		typedef T value_type;
+		typedef size_t size_type;
+
+		static constexpr size_type npos = size_type(-1);
+
+		mapped_trie() {}
+
+		explicit mapped_trie(const std::string& path) {
+			const int fd = ::open(path.c_str(), O_RDONLY);
+			if (fd < 0) throw std::system_error(errno, std::generic_category(), "ds::mapped_trie: " + path);
+
+			struct stat info;
+			if (::fstat(fd, &info) < 0) {
+				const int error = errno;
+				::close(fd);
+				throw std::system_error(error, std::generic_category(), "ds::mapped_trie: " + path);
+			}
+
+			m_length = info.st_size;
+			void* data = m_length ? ::mmap(nullptr, m_length, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+			const int error = errno;
+			::close(fd);
+			if (data == MAP_FAILED) {
+				m_length = 0;
+				throw std::system_error(error, std::generic_category(), "ds::mapped_trie: " + path);
+			}
+
+			m_data = static_cast<const char*>(data);
+			if (!attach()) {
+				unmap();
+				throw std::runtime_error("ds::mapped_trie: " + path + " is not a frozen trie");
+			}
+		}
+
+		mapped_trie(const mapped_trie&) = delete;
+
+		mapped_trie(mapped_trie&& other) { this->swap(other); }
+
+		mapped_trie& operator=(const mapped_trie&) = delete;
+
+		mapped_trie& operator=(mapped_trie&& other) {
+			this->swap(other);
+			return *this;
+		}
+
+		~mapped_trie() { unmap(); }
+
+		const T& at(const Key& key) const {
+			const T* val = find(key);
+			if (!val) throw std::out_of_range("ds::mapped_trie::at");
+			return *val;
+		}
+
+		/**
+		 * returns a pointer to the value stored under key or nullptr
+		 */
+		const T* find(const Key& key) const {
+			const size_type node = descend(key);
+			if (node == npos || !m_terminal[node]) return nullptr;
+			return m_values + m_terminal.rank1(node);
+		}
+
+		bool contains(const Key& key) const { return find(key); }
+
+		/**
+		 * returns true if any key starts with prefix
+		 */
+		bool has_prefix(const Key& prefix) const { return descend(prefix) != npos; }
+
+		/**
+		 * calls f(key, value) for every key starting with prefix
+		 */
+		template <class Function>
+		void for_each_with_prefix(const Key& prefix, Function f) const {
+			const size_type node = descend(prefix);
+			if (node == npos) return;
+			Key key = prefix;
+			visit(node, key, f);
+		}
+
+		bool empty() const { return m_key_count == 0; }
+
+		size_type size() const { return m_key_count; }
+
+		void swap(mapped_trie& other) {
+			std::swap(m_data, other.m_data);
+			std::swap(m_length, other.m_length);
+			std::swap(m_louds, other.m_louds);
+			std::swap(m_terminal, other.m_terminal);
+			std::swap(m_labels, other.m_labels);
+			std::swap(m_values, other.m_values);
+			std::swap(m_key_count, other.m_key_count);
+		}
+
+	private:
+		const char* m_data = nullptr;
+		size_t m_length = 0;
+		louds_bits m_louds;
+		louds_bits m_terminal;
+		const digit_type* m_labels = nullptr;
+		const T* m_values = nullptr;
+		size_type m_key_count = 0;
+
+		bool attach() {
+			mapped_trie_header header;
+			if (m_length < sizeof(header)) return false;
+			std::memcpy(&header, m_data, sizeof(header));
+			if (std::memcmp(header.magic, mapped_trie_magic, sizeof(header.magic))
+			    || header.digit_size != sizeof(digit_type) || header.value_size != sizeof(T)
+			    || header.file_size != m_length || header.node_count == 0)
+				return false;
+
+			// every node has a label, so a count beyond the file is corrupt and
+			// bounding it first keeps the section sizes below from overflowing
+			if (header.node_count > m_length || header.key_count > header.node_count) return false;
+
+			auto words = [](uint64_t bits) { return (bits + 63)/64; };
+			auto rank_words = [](uint64_t words) { return (words + mapped_trie_block_words - 1)/mapped_trie_block_words; };
+			const uint64_t louds_words = words(2*header.node_count - 1);
+			const uint64_t terminal_words = words(header.node_count);
+
+			// each section must be 8 byte aligned, after the header and end inside the mapping
+			auto fits = [this](uint64_t offset, uint64_t bytes) {
+				return offset%8 == 0 && offset >= sizeof(mapped_trie_header) && offset <= m_length
+				    && bytes <= m_length - offset;
+			};
+			if (!fits(header.louds_offset, louds_words*sizeof(uint64_t))
+			    || !fits(header.louds_rank_offset, rank_words(louds_words)*sizeof(uint64_t))
+			    || !fits(header.labels_offset, header.node_count*sizeof(digit_type))
+			    || !fits(header.terminal_offset, terminal_words*sizeof(uint64_t))
+			    || !fits(header.terminal_rank_offset, rank_words(terminal_words)*sizeof(uint64_t))
+			    || header.key_count > (m_length - std::min<uint64_t>(header.values_offset, m_length))/sizeof(T)
+			    || !fits(header.values_offset, header.key_count*sizeof(T)))
+				return false;
+
+			const uint64_t* louds = reinterpret_cast<const uint64_t*>(m_data + header.louds_offset);
+			const uint64_t* louds_rank = reinterpret_cast<const uint64_t*>(m_data + header.louds_rank_offset);
+			const uint64_t* terminal = reinterpret_cast<const uint64_t*>(m_data + header.terminal_offset);
+			const uint64_t* terminal_rank = reinterpret_cast<const uint64_t*>(m_data + header.terminal_rank_offset);
+			const uint64_t louds_size = 2*header.node_count - 1;
+
+			// Lookups trust the bits, so they are checked once here: every rank
+			// sample must match, each edge must lead to a node after its parent,
+			// the louds bits must hold node_count zeros and end in one, and the
+			// terminal bits must mark key_count nodes. Then select0 and next0
+			// stay inside the bits and every node id indexes a label.
+			auto scan = [](const uint64_t* bits, const uint64_t* ranks, uint64_t size, auto&& accept) {
+				uint64_t ones = 0;
+				for (uint64_t word = 0; word < (size + 63)/64; ++word) {
+					if (word%mapped_trie_block_words == 0 && ranks[word/mapped_trie_block_words] != ones) return false;
+					uint64_t set = bits[word];
+					if (word == size/64) set &= (uint64_t(1) << (size%64)) - 1;
+					for (; set; set &= set - 1, ++ones)
+						if (!accept(word*64 + __builtin_ctzll(set), ones)) return false;
+				}
+				return accept(size, ones);
+			};
+			// the one at pos is the edge from node pos - ones to node ones + 1
+			auto edge = [&](uint64_t pos, uint64_t ones) {
+				return pos == louds_size ? ones == header.node_count - 1 && !((louds[(pos-1)/64] >> ((pos-1)%64)) & 1)
+				                         : pos - ones <= ones;
+			};
+			auto keys = [&](uint64_t pos, uint64_t ones) { return pos < header.node_count || ones == header.key_count; };
+			if (!scan(louds, louds_rank, louds_size, edge) || !scan(terminal, terminal_rank, header.node_count, keys))
+				return false;
+
+			m_louds = louds_bits(louds, louds_rank, louds_size);
+			m_terminal = louds_bits(terminal, terminal_rank, header.node_count);
+			m_labels = reinterpret_cast<const digit_type*>(m_data + header.labels_offset);
+			m_values = reinterpret_cast<const T*>(m_data + header.values_offset);
+			m_key_count = header.key_count;
+			return true;
+		}
+
+		void unmap() {
+			if (m_data) ::munmap(const_cast<char*>(m_data), m_length);
+			m_data = nullptr;
+			m_length = 0;
+		}
+
+		/**
+		 * returns the id of the first child of node and sets count to the
+		 * number of children it has
+		 */
+		size_type children(size_type node, size_type& count) const {
+			const size_type start = node ? m_louds.select0(node-1) + 1 : 0;
+			count = m_louds.next0(start) - start;
+			return start - node + 1;
+		}
+
+		size_type descend(const Key& key) const {
+			if (!m_data) return npos;
+			size_type node = 0;
+			for (const auto& digit : key) {
+				size_type count;
+				const size_type first = children(node, count);
+				const digit_type* label = std::lower_bound(m_labels + first, m_labels + first + count, digit);
+				if (label == m_labels + first + count || !(*label == digit)) return npos;
+				node = label - m_labels;
+			}
+			return node;
+		}
+
+		template <class Function>
+		void visit(size_type node, Key& key, Function& f) const {
+			if (m_terminal[node]) f(static_cast<const Key&>(key), m_values[m_terminal.rank1(node)]);
+
+			size_type count;
+			const size_type first = children(node, count);
+			for (size_type child = first; child < first + count; ++child) {
+				key.push_back(m_labels[child]);
+				visit(child, key, f);
+				key.pop_back();
+			}
+		}
+	};
+}
+
+namespace std {
+	template <class Key, class T>
+	void swap(ds::mapped_trie<Key, T>& lhs, ds::mapped_trie<Key, T>& rhs) { lhs.swap(rhs); }
+}
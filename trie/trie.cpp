@@ -1,8 +1,14 @@
 /**
  * Linked Trie
  */
+#pragma once
+
  #include <utility>
  #include <stdexcept>
+ #include <algorithm>
+ #include <functional>
+ #include <iterator>
+ #include <vector>
 
 namespace ds {
 
@@ -15,6 +21,24 @@ namespace ds {
 		Node<Digit, T>* next = nullptr;
 	};
 
+	/**
+	 * Shape and memory usage of a trie, as returned by trie::stats. Byte counts
+	 * cover the nodes, digits and values owned by the trie but not the
+	 * bookkeeping of the underlying allocator.
+	 */
+	struct trie_stats {
+		size_t node_count = 0;
+		size_t key_count = 0;
+		// depth_histogram[d] is the number of nodes d digits below the root
+		std::vector<size_t> depth_histogram;
+		// fanout_histogram[n] is the number of nodes with n children
+		std::vector<size_t> fanout_histogram;
+		size_t bytes_allocated = 0;
+		// bytes spent on digits and values, the rest is structure
+		size_t payload_bytes = 0;
+		double wasted_bytes_per_key = 0;
+	};
+
 	template <class Key, class T>
 	class trie {
 	public:
@@ -47,6 +71,8 @@ namespace ds {
 
 		node_type* top() { return &m_root; }
 
+		const node_type* top() const { return &m_root; }
+
 		bool empty() const { return m_root.child; }
 
 		size_t size() const { return m_size; }
@@ -55,6 +81,19 @@ namespace ds {
 			for (node_type* child = m_root.child; child;)
 				child = destroy(child);
 
+			if (m_root.val) delete m_root.val;
+			m_root.val = nullptr;
+			m_root.child = nullptr;
+
+			while (m_blocks) {
+				node_block* next = m_blocks->next;
+				delete[] m_blocks->nodes;
+				delete[] m_blocks->digits;
+				delete m_blocks;
+				m_blocks = next;
+			}
+			m_sorted_blocks.clear();
+
 			m_size = 0;
 		}
 
@@ -90,6 +129,49 @@ namespace ds {
 			return current;
 		}
 
+		/**
+		 * Replaces the contents with the keys in [first, last), which must be
+		 * sorted. Elements are either keys or (key, value) pairs. Each key only
+		 * walks the part that differs from the previous one, and nodes are taken
+		 * from contiguous blocks so they end up laid out in depth first order.
+		 */
+		template <class InputIterator>
+		void build_sorted(InputIterator first, InputIterator last) {
+			clear();
+
+			// path[d] is the node reached by the first d digits of the previous key
+			std::vector<node_type*> path = {&m_root};
+			for (; first != last; ++first) {
+				const Key& key = entry_key(*first);
+
+				auto digit = key.begin();
+				size_t common = 0;
+				for (; common+1 < path.size() && digit != key.end() && *path[common+1]->digit == *digit; ++digit)
+					++common;
+
+				node_type* sibling = common+1 < path.size() ? path[common+1] : nullptr;
+				path.resize(common+1);
+
+				for (; digit != key.end(); ++digit) {
+					node_type* parent = path.back();
+					if (sibling && !(*sibling->digit < *digit))
+						throw std::invalid_argument("ds::trie::build_sorted");
+
+					node_type* node = allocate_node(*digit, parent);
+					if (sibling) sibling->next = node;
+					else parent->child = node;
+
+					sibling = nullptr;
+					path.push_back(node);
+				}
+
+				node_type* node = path.back();
+				if (node->val) delete node->val;
+				else ++m_size;
+				node->val = entry_value(*first);
+			}
+		}
+
 		void erase(node_type* node) {
 			if (!node) throw std::invalid_argument("ds::trie::erase");
 			node_type* current = node;
@@ -97,14 +179,12 @@ namespace ds {
 			delete current->val;
 			current->val = nullptr;
 			while (parent && !current->child && !current->val) {
-				delete current->digit;
-
 				node_type before_begin = {nullptr, nullptr, nullptr, nullptr, parent->child};
 
 				for (node_type *prev = &before_begin, *it = prev->next; it;) {
 					if (it == current) {
 						prev->next = current->next;
-						delete current;
+						release(current);
 						parent->child = before_begin.next;
 						break;
 					}
@@ -123,6 +203,8 @@ namespace ds {
 		void swap(trie& other) {
 			std::swap(m_root, other.m_root);
 			std::swap(m_size, other.m_size);
+			std::swap(m_blocks, other.m_blocks);
+			std::swap(m_sorted_blocks, other.m_sorted_blocks);
 		}
 
 		node_type* find(const Key& key) {
@@ -161,11 +243,116 @@ namespace ds {
 			return current;
 		}
 
+		trie_stats stats() const {
+			trie_stats result;
+			collect_stats(&m_root, 0, result);
+
+			// the root is embedded in the trie and has no digit
+			result.bytes_allocated -= sizeof(node_type) + sizeof(digit_type);
+			// blocks stay allocated whole, including the slots of erased nodes
+			for (const node_block* block = m_blocks; block; block = block->next)
+				result.bytes_allocated += sizeof(node_block) + block->capacity*(sizeof(node_type) + sizeof(digit_type));
+
+			result.payload_bytes = (result.node_count - 1)*sizeof(digit_type) + result.key_count*sizeof(T);
+			if (result.key_count)
+				result.wasted_bytes_per_key = double(result.bytes_allocated - result.payload_bytes)/result.key_count;
+			return result;
+		}
+
+		/**
+		 * Looks up every key in keys and writes the result of find for the i-th
+		 * key to out[i]. Up to batch_lanes lookups are in flight at once and each
+		 * one prefetches the node it needs next before yielding to the others,
+		 * so the cache misses of different keys overlap.
+		 */
+		template <class Keys, class RandomAccessIterator>
+		void find_batch(const Keys& keys, RandomAccessIterator out) {
+			typedef decltype(std::begin(*std::begin(keys))) digit_iterator;
+			struct lane {
+				size_t index;
+				digit_iterator digit, last;
+				node_type* child;
+				bool loaded;
+			};
+
+			lane lanes[batch_lanes];
+			size_t active = 0, index = 0;
+			auto next_key = std::begin(keys);
+
+			auto start = [&](lane& l) {
+				for (; next_key != std::end(keys); ++next_key) {
+					l.index = index++;
+					l.digit = std::begin(*next_key);
+					l.last = std::end(*next_key);
+					if (l.digit == l.last) {
+						out[l.index] = &m_root;
+						continue;
+					}
+					l.child = m_root.child;
+					l.loaded = false;
+					prefetch(l.child);
+					++next_key;
+					return true;
+				}
+				return false;
+			};
+
+			while (active < batch_lanes && start(lanes[active]))
+				++active;
+
+			while (active) {
+				for (size_t i = 0; i < active;) {
+					lane& l = lanes[i];
+					if (!l.child) {
+						out[l.index] = nullptr;
+					} else if (!l.loaded) {
+						// the node has arrived, its digit lives in a separate allocation
+						prefetch(l.child->digit);
+						l.loaded = true;
+						++i;
+						continue;
+					} else if (*l.child->digit == *l.digit) {
+						if (++l.digit == l.last) {
+							out[l.index] = l.child;
+						} else {
+							l.child = l.child->child;
+							l.loaded = false;
+							prefetch(l.child);
+							++i;
+							continue;
+						}
+					} else {
+						l.child = l.child->next;
+						l.loaded = false;
+						prefetch(l.child);
+						++i;
+						continue;
+					}
+
+					if (!start(l)) l = lanes[--active];
+				}
+			}
+		}
+
 		~trie() { clear(); }
 
 	private:
+		static constexpr size_t batch_lanes = 16;
+
+		// contiguous storage for nodes created by build_sorted
+		struct node_block {
+			node_type* nodes;
+			digit_type* digits;
+			size_t size;
+			size_t capacity;
+			node_block* next;
+		};
+
 		node_type m_root;
-		size_t m_size;
+		size_t m_size = 0;
+		node_block* m_blocks = nullptr;
+		// the same blocks ordered by address, so in_block can binary search
+		std::vector<const node_block*> m_sorted_blocks;
 
 		node_type* destroy(node_type* root) {
 			for (node_type* child = root->child; child;)
@@ -173,10 +360,93 @@ namespace ds {
 
 			node_type* next = root->next;
 			if (root->val) delete root->val;
-			delete root->digit;
-			delete root;
+			release(root);
 			return next;
 		}
+
+		node_type* allocate_node(const digit_type& digit, node_type* parent) {
+			if (!m_blocks || m_blocks->size == m_blocks->capacity) {
+				const size_t capacity = m_blocks ? std::min<size_t>(2*m_blocks->capacity, 1 << 16) : 64;
+				m_blocks = new node_block{new node_type[capacity], new digit_type[capacity], 0, capacity, m_blocks};
+				m_sorted_blocks.insert(std::upper_bound(m_sorted_blocks.begin(), m_sorted_blocks.end(), m_blocks, block_less),
+				                       m_blocks);
+			}
+
+			node_type* node = m_blocks->nodes + m_blocks->size;
+			node->digit = m_blocks->digits + m_blocks->size++;
+			*node->digit = digit;
+			node->parent = parent;
+			return node;
+		}
+
+		static bool block_less(const node_block* lhs, const node_block* rhs) {
+			return std::less<const node_type*>()(lhs->nodes, rhs->nodes);
+		}
+
+		/**
+		 * whether node lives in a build_sorted block, in O(log blocks)
+		 */
+		bool in_block(const node_type* node) const {
+			if (m_sorted_blocks.empty()) return false;
+			std::less<const node_type*> less;
+			// the last block starting at or before node
+			auto it = std::upper_bound(m_sorted_blocks.begin(), m_sorted_blocks.end(), node,
+			                           [&less](const node_type* n, const node_block* block) { return less(n, block->nodes); });
+			if (it == m_sorted_blocks.begin()) return false;
+			--it;
+			return less(node, (*it)->nodes + (*it)->capacity);
+		}
+
+		/**
+		 * frees a node unless it lives in one of the build_sorted blocks, which
+		 * are released together by clear
+		 */
+		void release(node_type* node) {
+			if (in_block(node)) return;
+			delete node->digit;
+			delete node;
+		}
+
+		void collect_stats(const node_type* node, size_t depth, trie_stats& result) const {
+			size_t fanout = 0;
+			for (const node_type* child = node->child; child; child = child->next, ++fanout)
+				collect_stats(child, depth+1, result);
+
+			++result.node_count;
+			// nodes in build_sorted blocks are counted with their block by stats
+			if (!in_block(node)) result.bytes_allocated += sizeof(node_type) + sizeof(digit_type);
+			if (node->val) {
+				++result.key_count;
+				result.bytes_allocated += sizeof(T);
+			}
+
+			if (result.depth_histogram.size() <= depth) result.depth_histogram.resize(depth+1);
+			++result.depth_histogram[depth];
+			if (result.fanout_histogram.size() <= fanout) result.fanout_histogram.resize(fanout+1);
+			++result.fanout_histogram[fanout];
+		}
+
+		static void prefetch(const void* address) {
+			if (address) __builtin_prefetch(address);
+		}
+
+		/**
+		 * Entries that are a Key are passed through, anything only convertible
+		 * to Key is converted into a returned temporary, which the caller's
+		 * const Key& keeps alive.
+		 */
+		static const Key& entry_key(const Key& key) { return key; }
+
+		template <class K>
+		static Key entry_key(const K& key) { return Key(key); }
+
+		template <class K, class V>
+		static decltype(auto) entry_key(const std::pair<K, V>& entry) { return entry_key(entry.first); }
+
+		static T* entry_value(const Key&) { return new T(); }
+
+		template <class K, class V>
+		static T* entry_value(const std::pair<K, V>& entry) { return new T(entry.second); }
 	};
 }
 
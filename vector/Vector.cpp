@@ -4,8 +4,12 @@
  * @author Dougal Stewart
  * @version 0.1 18/8/18
  */
+#pragma once
+
+#include "simd.cpp"
 
 #include <stddef.h>
+#include <algorithm>
 #include <memory>
 #include <initializer_list>
 #include <iterator>
@@ -56,6 +60,7 @@ public:
 
 	explicit Vector(size_type n, const allocator_type& alloc = allocator_type()) : m_allocator(alloc)  {
 		create_storage(n);
+		m_end = std::uninitialized_value_construct_n(m_start, n);
 	}
 
 	Vector(size_type n, const value_type& val, const allocator_type& alloc = allocator_type()) : m_allocator(alloc) {
@@ -71,7 +76,7 @@ public:
 		m_end_of_storage = m_end;
 	}
 
-	Vector(const Vector& x) {
+	Vector(const Vector& x) : m_allocator(Alloc_traits::select_on_container_copy_construction(x.m_allocator)) {
 		m_start = allocate(x.size());
 		m_end = std::uninitialized_copy(x.begin(), x.end(), m_start);
 		m_end_of_storage = m_end;
@@ -83,11 +88,11 @@ public:
 		m_end_of_storage = m_end;
 	}
 
-	Vector(Vector&& x) {
+	Vector(Vector&& x) : m_start(), m_end(), m_end_of_storage(), m_allocator() {
 		this->swap(x);
 	}
 
-	Vector(Vector&& x, const allocator_type& alloc) : m_allocator(alloc) {
+	Vector(Vector&& x, const allocator_type& alloc) : m_start(), m_end(), m_end_of_storage(), m_allocator(alloc) {
 		this->swap(x);
 	}
 
@@ -288,6 +293,56 @@ public:
 		return m_start;
 	}
 
+	// Search
+
+	/**
+	 * returns an iterator to the first element equal to val, or end(), comparing
+	 * several elements per instruction for arithmetic types
+	 */
+	iterator find(const value_type& val) {
+		return begin() + (ds::simd::find(cbegin(), cend(), val) - cbegin());
+	}
+
+	const_iterator find(const value_type& val) const {
+		return ds::simd::find(cbegin(), cend(), val);
+	}
+
+	/**
+	 * returns the number of elements equal to val
+	 */
+	size_type count(const value_type& val) const {
+		return ds::simd::count(cbegin(), cend(), val);
+	}
+
+	/**
+	 * returns true if an element is equal to val
+	 */
+	bool contains(const value_type& val) const {
+		return find(val) != cend();
+	}
+
+	/**
+	 * returns an iterator to the first smallest element, or end() if the vector is empty
+	 */
+	iterator min_element() {
+		return begin() + (ds::simd::min_element(cbegin(), cend()) - cbegin());
+	}
+
+	const_iterator min_element() const {
+		return ds::simd::min_element(cbegin(), cend());
+	}
+
+	/**
+	 * returns an iterator to the first largest element, or end() if the vector is empty
+	 */
+	iterator max_element() {
+		return begin() + (ds::simd::max_element(cbegin(), cend()) - cbegin());
+	}
+
+	const_iterator max_element() const {
+		return ds::simd::max_element(cbegin(), cend());
+	}
+
 	// Modifiers
 
 	/**
@@ -427,8 +482,10 @@ public:
 	 * removes element pointed to by position from the vector
 	 */
 	iterator erase(const_iterator position) {
-		Alloc_traits::destroy(m_allocator, position);
-		m_end = std::uninitialized_move(iterator(position+1), end(), iterator(position));
+		iterator new_position = begin() + (position - cbegin());
+		std::move(new_position + 1, end(), new_position);
+		pop_back();
+		return new_position;
 	}
 
 	/**
@@ -437,8 +494,11 @@ public:
 	 * @param last element after the last to be removed
 	 */
 	iterator erase(const_iterator first, const_iterator last) {
-		std::destroy(first, last);
-		m_end = std::uninitialized_move(iterator(last), end(), iterator(first));
+		iterator new_first = begin() + (first - cbegin());
+		iterator new_end = std::move(new_first + (last - first), end(), new_first);
+		std::destroy(new_end, end());
+		m_end = new_end;
+		return new_first;
 	}
 
 
@@ -470,19 +530,25 @@ public:
 
 		difference_type offset = position-begin();
 
-		if (m_end == m_end_of_storage) {
-			if (empty()) {
-				create_storage(1);
-			} else {
-				reallocate(growth_factor*capacity());
-			}
+		if (position == cend()) {
+			emplace_back(std::forward<Args>(args)...);
+			return begin() + offset;
 		}
 
+		// args may refer to an element that is about to move
+		value_type val(std::forward<Args>(args)...);
+
+		if (m_end == m_end_of_storage)
+			reallocate(growth_factor*capacity());
+
+		Alloc_traits::construct(m_allocator, m_end, std::move(*(m_end-1)));
+		++m_end;
+
 		iterator new_position = begin() + offset;
 
-		m_end = std::uninitialized_move(iterator(new_position), iterator(m_end), iterator(new_position+1));
+		std::move_backward(new_position, m_end-2, m_end-1);
 
-		Alloc_traits::construct(m_allocator, new_position, std::forward<Args>(args)...);
+		*new_position = std::move(val);
 
 		return new_position;
 	}
@@ -494,11 +560,25 @@ public:
 	template <class... Args>
 	void emplace_back(Args&&... args) {
 		if (m_end == m_end_of_storage) {
-			if (empty()) {
-				create_storage(1);
-			} else {
-				reallocate(growth_factor*capacity());
+			// args may refer to an element that is about to move, so the new
+			// element is constructed in the new storage first
+			const size_type n = empty() ? 1 : growth_factor*capacity();
+			pointer new_start = allocate(n);
+			try {
+				Alloc_traits::construct(m_allocator, new_start + size(), std::forward<Args>(args)...);
+			} catch (...) {
+				deallocate(new_start, n);
+				throw;
 			}
+			pointer new_end = std::uninitialized_move(m_start, m_end, new_start) + 1;
+
+			std::destroy(m_start, m_end);
+			deallocate(m_start, m_end_of_storage - m_start);
+
+			m_start          = new_start;
+			m_end            = new_end;
+			m_end_of_storage = new_start + n;
+			return;
 		}
 
 		Alloc_traits::construct(m_allocator, m_end, std::forward<Args>(args)...);
@@ -520,6 +600,40 @@ public:
 		first.swap(second);
 	}
 
+	friend bool operator==(const Vector& lhs, const Vector& rhs) {
+		return lhs.size() == rhs.size() && ds::simd::equal(lhs.data(), rhs.data(), lhs.size());
+	}
+
+	friend bool operator!=(const Vector& lhs, const Vector& rhs) {
+		return !(lhs == rhs);
+	}
+
+	/**
+	 * lexicographical comparison, integers skip the equal prefix with a
+	 * vectorized mismatch
+	 */
+	friend bool operator<(const Vector& lhs, const Vector& rhs) {
+		if constexpr (std::is_integral<value_type>::value) {
+			const size_type common = std::min(lhs.size(), rhs.size());
+			const size_type n = ds::simd::mismatch(lhs.data(), rhs.data(), common);
+			return n == common ? lhs.size() < rhs.size() : lhs[n] < rhs[n];
+		} else {
+			return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+		}
+	}
+
+	friend bool operator<=(const Vector& lhs, const Vector& rhs) {
+		return !(rhs < lhs);
+	}
+
+	friend bool operator>(const Vector& lhs, const Vector& rhs) {
+		return rhs < lhs;
+	}
+
+	friend bool operator>=(const Vector& lhs, const Vector& rhs) {
+		return !(lhs < rhs);
+	}
+
 private:
 
 	pointer m_start;
@@ -558,6 +672,7 @@ private:
 		pointer new_end            = std::uninitialized_move(m_start, m_end, new_start);
 		pointer new_end_of_storage = new_start + n;
 
+		std::destroy(m_start, m_end);
 		deallocate(m_start, m_end_of_storage - m_start);
 
 		m_start          = new_start;
@@ -0,0 +1,309 @@
+/**
+ * Concurrent vector
+ *
+ * Append only vector whose elements never move. Storage is a table of
+ * segments where segment k holds first_segment << k elements, so index i
+ * lives in segment log2(i + first_segment) - log2(first_segment) and a lookup
+ * is a bit scan plus two loads. push_back claims a slot with one atomic
+ * increment and allocates a missing segment with a compare and swap, so any
+ * number of threads can append without a lock while others read.
+ */
+#include <stddef.h>
+#include <atomic>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ds {
+
+	template <class T, class Allocator = std::allocator<T>>
+	class concurrent_vector {
+
+		typedef std::allocator_traits<Allocator> Alloc_traits;
+
+		static_assert(std::is_nothrow_move_constructible<T>::value,
+		              "ds::concurrent_vector: elements are moved into their slot and that must not throw");
+
+	public:
+		typedef T value_type;
+		typedef Allocator allocator_type;
+		typedef size_t size_type;
+		typedef ptrdiff_t difference_type;
+		typedef value_type& reference;
+		typedef const value_type& const_reference;
+		typedef typename Alloc_traits::pointer pointer;
+		typedef typename Alloc_traits::const_pointer const_pointer;
+
+		static constexpr size_type first_segment = 8;
+		static constexpr size_type max_segments = 64 - 3;
+
+		template <bool is_const>
+		class basic_iterator {
+			typedef typename std::conditional<is_const, const concurrent_vector*, concurrent_vector*>::type vector_pointer;
+
+		public:
+			typedef std::random_access_iterator_tag iterator_category;
+			typedef T value_type;
+			typedef ptrdiff_t difference_type;
+			typedef typename std::conditional<is_const, const T*, T*>::type pointer;
+			typedef typename std::conditional<is_const, const T&, T&>::type reference;
+
+			basic_iterator() : m_vector(), m_index() {}
+
+			basic_iterator(vector_pointer vector, size_type index) : m_vector(vector), m_index(index) {}
+
+			template <bool other_const, class = typename std::enable_if<is_const && !other_const>::type>
+			basic_iterator(const basic_iterator<other_const>& other) : m_vector(other.m_vector), m_index(other.m_index) {}
+
+			reference operator*() const { return (*m_vector)[m_index]; }
+
+			pointer operator->() const { return &(*m_vector)[m_index]; }
+
+			reference operator[](difference_type n) const { return (*m_vector)[m_index + n]; }
+
+			basic_iterator& operator++() {
+				++m_index;
+				return *this;
+			}
+
+			basic_iterator operator++(int) { return basic_iterator(m_vector, m_index++); }
+
+			basic_iterator& operator--() {
+				--m_index;
+				return *this;
+			}
+
+			basic_iterator operator--(int) { return basic_iterator(m_vector, m_index--); }
+
+			basic_iterator& operator+=(difference_type n) {
+				m_index += n;
+				return *this;
+			}
+
+			basic_iterator& operator-=(difference_type n) {
+				m_index -= n;
+				return *this;
+			}
+
+			basic_iterator operator+(difference_type n) const { return basic_iterator(m_vector, m_index + n); }
+
+			friend basic_iterator operator+(difference_type n, const basic_iterator& it) { return it + n; }
+
+			basic_iterator operator-(difference_type n) const { return basic_iterator(m_vector, m_index - n); }
+
+			difference_type operator-(const basic_iterator& rhs) const { return m_index - rhs.m_index; }
+
+			bool operator==(const basic_iterator& rhs) const { return m_index == rhs.m_index; }
+
+			bool operator!=(const basic_iterator& rhs) const { return m_index != rhs.m_index; }
+
+			bool operator<(const basic_iterator& rhs) const { return m_index < rhs.m_index; }
+
+			bool operator>(const basic_iterator& rhs) const { return m_index > rhs.m_index; }
+
+			bool operator<=(const basic_iterator& rhs) const { return m_index <= rhs.m_index; }
+
+			bool operator>=(const basic_iterator& rhs) const { return m_index >= rhs.m_index; }
+
+		private:
+			friend class concurrent_vector;
+
+			vector_pointer m_vector;
+			size_type m_index;
+		};
+
+		typedef basic_iterator<false> iterator;
+		typedef basic_iterator<true> const_iterator;
+
+		// Constructors, Destructors and Assignment
+
+		concurrent_vector() : concurrent_vector(allocator_type()) {}
+
+		explicit concurrent_vector(const allocator_type& alloc) : m_size(0), m_allocator(alloc) {
+			for (auto& segment : m_segments)
+				segment.store(nullptr, std::memory_order_relaxed);
+		}
+
+		template <class InputIterator, class = typename std::iterator_traits<InputIterator>::iterator_category>
+		concurrent_vector(InputIterator first, InputIterator last, const allocator_type& alloc = allocator_type())
+			: concurrent_vector(alloc) {
+			for (; first != last; ++first)
+				emplace_back(*first);
+		}
+
+		concurrent_vector(std::initializer_list<value_type> il, const allocator_type& alloc = allocator_type())
+			: concurrent_vector(il.begin(), il.end(), alloc) {}
+
+		concurrent_vector(const concurrent_vector& other)
+			: concurrent_vector(other.begin(), other.end(),
+			                    Alloc_traits::select_on_container_copy_construction(other.m_allocator)) {}
+
+		concurrent_vector& operator=(const concurrent_vector&) = delete;
+
+		/**
+		 * must not run concurrently with any other member
+		 */
+		~concurrent_vector() { clear(); }
+
+		allocator_type get_allocator() const { return m_allocator; }
+
+		// Element access
+
+		/**
+		 * The element must have been appended before, e.g. by an index the
+		 * reading thread got from push_back. Unchecked: an index below size()
+		 * that another thread has claimed but not yet placed may find its
+		 * segment still null and dereference it.
+		 */
+		reference operator[](size_type n) {
+			const size_type segment = segment_of(n);
+			return m_segments[segment].load(std::memory_order_acquire)[n + first_segment - segment_base(segment)];
+		}
+
+		const_reference operator[](size_type n) const { return const_cast<concurrent_vector&>(*this)[n]; }
+
+		reference at(size_type n) {
+			if (n >= size()) throw std::out_of_range("ds::concurrent_vector::at");
+			return (*this)[n];
+		}
+
+		const_reference at(size_type n) const {
+			if (n >= size()) throw std::out_of_range("ds::concurrent_vector::at");
+			return (*this)[n];
+		}
+
+		reference front() { return (*this)[0]; }
+
+		const_reference front() const { return (*this)[0]; }
+
+		// Iterators
+
+		iterator begin() { return iterator(this, 0); }
+
+		const_iterator begin() const { return const_iterator(this, 0); }
+
+		const_iterator cbegin() const { return begin(); }
+
+		iterator end() { return iterator(this, size()); }
+
+		const_iterator end() const { return const_iterator(this, size()); }
+
+		const_iterator cend() const { return end(); }
+
+		// Capacity
+
+		/**
+		 * number of claimed slots, while other threads append the last few
+		 * may still be under construction
+		 */
+		size_type size() const { return m_size.load(std::memory_order_acquire); }
+
+		bool empty() const { return size() == 0; }
+
+		size_type max_size() const { return Alloc_traits::max_size(m_allocator); }
+
+		/**
+		 * allocates the segments needed to hold n elements
+		 */
+		void reserve(size_type n) {
+			if (n > max_size()) throw std::length_error("ds::concurrent_vector::reserve");
+			for (size_type segment = 0; n > 0 && segment <= segment_of(n - 1); ++segment)
+				allocate_segment(segment);
+		}
+
+		// Modifiers
+
+		/**
+		 * must not run concurrently with any other member
+		 */
+		void clear() {
+			const size_type size = m_size.load(std::memory_order_relaxed);
+			for (size_type n = 0; n < size; ++n)
+				Alloc_traits::destroy(m_allocator, &(*this)[n]);
+			for (size_type segment = 0; segment < max_segments; ++segment) {
+				if (T* storage = m_segments[segment].load(std::memory_order_relaxed)) {
+					Alloc_traits::deallocate(m_allocator, storage, segment_base(segment));
+					m_segments[segment].store(nullptr, std::memory_order_relaxed);
+				}
+			}
+			m_size.store(0, std::memory_order_relaxed);
+		}
+
+		iterator push_back(const value_type& val) { return emplace_back(val); }
+
+		iterator push_back(value_type&& val) { return emplace_back(std::move(val)); }
+
+		/**
+		 * Constructs the element before claiming a slot, so a throwing
+		 * constructor leaves the vector unchanged, then moves it into place.
+		 * Returns an iterator to the new element; the index is it - begin().
+		 */
+		template <class... Args>
+		iterator emplace_back(Args&&... args) {
+			value_type val(std::forward<Args>(args)...);
+			const size_type n = m_size.fetch_add(1, std::memory_order_acq_rel);
+			place(n, std::move(val));
+			return iterator(this, n);
+		}
+
+		/**
+		 * Appends count copies of val in one reservation, their slots are
+		 * contiguous in index order. Like emplace_back the copies are made
+		 * before the slots are claimed, so a throwing copy constructor leaves
+		 * the vector unchanged.
+		 */
+		iterator grow_by(size_type count, const value_type& val) {
+			if constexpr (std::is_nothrow_copy_constructible<T>::value) {
+				const size_type first = m_size.fetch_add(count, std::memory_order_acq_rel);
+				for (size_type n = first; n < first + count; ++n)
+					place(n, value_type(val));
+				return iterator(this, first);
+			} else {
+				std::vector<value_type> copies(count, val);
+				const size_type first = m_size.fetch_add(count, std::memory_order_acq_rel);
+				for (size_type n = 0; n < count; ++n)
+					place(first + n, std::move(copies[n]));
+				return iterator(this, first);
+			}
+		}
+
+	private:
+		std::atomic<T*> m_segments[max_segments];
+		std::atomic<size_type> m_size;
+		allocator_type m_allocator;
+
+		static size_type segment_of(size_type n) {
+			return (63 - __builtin_clzll(static_cast<unsigned long long>(n + first_segment))) - 3;
+		}
+
+		/**
+		 * the number of elements in segments before segment, plus first_segment,
+		 * which is also the size of segment itself
+		 */
+		static size_type segment_base(size_type segment) { return first_segment << segment; }
+
+		T* allocate_segment(size_type segment) {
+			T* storage = m_segments[segment].load(std::memory_order_acquire);
+			if (storage) return storage;
+
+			T* fresh = Alloc_traits::allocate(m_allocator, segment_base(segment));
+			if (m_segments[segment].compare_exchange_strong(storage, fresh, std::memory_order_acq_rel)) return fresh;
+			Alloc_traits::deallocate(m_allocator, fresh, segment_base(segment));
+			return storage;
+		}
+
+		/**
+		 * The slot is already claimed and cannot be given back, so failing to
+		 * allocate its segment terminates.
+		 */
+		void place(size_type n, value_type&& val) noexcept {
+			const size_type segment = segment_of(n);
+			T* storage = allocate_segment(segment);
+			Alloc_traits::construct(m_allocator, storage + (n + first_segment - segment_base(segment)), std::move(val));
+		}
+	};
+}
@@ -0,0 +1,141 @@
+/**
+ * Huge page allocator
+ *
+ * Allocator for large Vector buffers on Linux. Requests below a threshold go
+ * to operator new as usual; larger ones are mapped directly, rounded up to a
+ * whole 2 MiB huge page, and either taken from the reserved hugetlbfs pool or
+ * marked for transparent huge pages, so a scan over the buffer needs about 512
+ * times fewer TLB entries.
+ *
+ * A mapped buffer can also be given a NUMA placement policy through mbind:
+ * interleaved across nodes, bound to nodes, preferring one node, or placed on
+ * the node of whichever thread first touches each page. The policy is part of
+ * the allocator's state, so it travels with the Vector that holds it.
+ */
+#include <stddef.h>
+#include <new>
+#include <type_traits>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace ds {
+
+	/**
+	 * where the pages of a mapped buffer are placed, mirrors the mbind modes
+	 */
+	enum class numa_policy {
+		// the process policy, normally the node of the thread that allocates
+		inherit = 0,
+		// fall back to another node only if the preferred one is full
+		preferred = 1,
+		// only the nodes in the mask
+		bind = 2,
+		// round robin page by page over the nodes in the mask
+		interleave = 3,
+		// the node of the thread that first touches each page, so a buffer
+		// filled in parallel ends up split the way it is used
+		first_touch = 4
+	};
+
+	template <class T>
+	class huge_page_allocator {
+	public:
+		typedef T value_type;
+		typedef size_t size_type;
+		typedef ptrdiff_t difference_type;
+		typedef std::true_type propagate_on_container_copy_assignment;
+		typedef std::true_type propagate_on_container_move_assignment;
+		typedef std::true_type propagate_on_container_swap;
+
+		static constexpr size_t huge_page_size = size_t(1) << 21;
+
+		/**
+		 * @param threshold smallest request in bytes that is mapped directly
+		 * @param policy NUMA placement of mapped buffers
+		 * @param nodes bit n selects node n, used by preferred, bind and interleave
+		 * @param use_hugetlb take pages from the hugetlbfs pool, falling back to
+		 *        transparent huge pages if it is empty
+		 */
+		explicit huge_page_allocator(size_t threshold = huge_page_size, numa_policy policy = numa_policy::inherit,
+		                             unsigned long nodes = 0, bool use_hugetlb = false) noexcept
+			: m_threshold(threshold), m_policy(policy), m_nodes(nodes), m_use_hugetlb(use_hugetlb) {}
+
+		template <class U>
+		huge_page_allocator(const huge_page_allocator<U>& other) noexcept
+			: m_threshold(other.threshold()), m_policy(other.policy()), m_nodes(other.nodes()),
+			  m_use_hugetlb(other.use_hugetlb()) {}
+
+		T* allocate(size_type n) {
+			if (n > size_t(-1) / sizeof(T)) throw std::bad_array_new_length();
+			const size_t bytes = n*sizeof(T);
+			if (bytes < m_threshold) return static_cast<T*>(::operator new(bytes));
+
+			const size_t length = mapped_length(bytes);
+			void* memory = MAP_FAILED;
+#ifdef MAP_HUGETLB
+			if (m_use_hugetlb)
+				memory = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+			if (memory == MAP_FAILED) {
+				memory = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+				if (memory == MAP_FAILED) throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+				madvise(memory, length, MADV_HUGEPAGE);
+#endif
+			}
+			place(memory, length);
+			return static_cast<T*>(memory);
+		}
+
+		void deallocate(T* p, size_type n) noexcept {
+			const size_t bytes = n*sizeof(T);
+			if (bytes < m_threshold) ::operator delete(p);
+			else munmap(p, mapped_length(bytes));
+		}
+
+		size_t threshold() const { return m_threshold; }
+
+		numa_policy policy() const { return m_policy; }
+
+		unsigned long nodes() const { return m_nodes; }
+
+		bool use_hugetlb() const { return m_use_hugetlb; }
+
+	private:
+		size_t m_threshold;
+		numa_policy m_policy;
+		unsigned long m_nodes;
+		bool m_use_hugetlb;
+
+		static size_t mapped_length(size_t bytes) { return (bytes + huge_page_size - 1) & ~(huge_page_size - 1); }
+
+		/**
+		 * Applies the policy before any page is touched. mbind fails on kernels
+		 * without NUMA support, where there is only one node to place pages on
+		 * anyway, so failures are ignored.
+		 */
+		void place(void* memory, size_t length) const {
+#ifdef SYS_mbind
+			if (m_policy == numa_policy::inherit) return;
+			const unsigned long* mask = m_policy == numa_policy::first_touch ? nullptr : &m_nodes;
+			const unsigned long max_node = m_policy == numa_policy::first_touch ? 0 : 8*sizeof(m_nodes);
+			syscall(SYS_mbind, memory, length, static_cast<int>(m_policy), mask, max_node, 0u);
+#else
+			(void)memory;
+			(void)length;
+#endif
+		}
+	};
+
+	template <class T, class U>
+	bool operator==(const huge_page_allocator<T>& lhs, const huge_page_allocator<U>& rhs) {
+		return lhs.threshold() == rhs.threshold() && lhs.policy() == rhs.policy() && lhs.nodes() == rhs.nodes()
+		       && lhs.use_hugetlb() == rhs.use_hugetlb();
+	}
+
+	template <class T, class U>
+	bool operator!=(const huge_page_allocator<T>& lhs, const huge_page_allocator<U>& rhs) {
+		return !(lhs == rhs);
+	}
+}
@@ -0,0 +1,364 @@
+/**
+ * SIMD search kernels
+ *
+ * find, count, mismatch, min and max over contiguous arrays of arithmetic
+ * types, comparing 32 bytes per step with AVX2 or 16 with SSE4.2. The kernel
+ * is chosen once at run time from what the CPU supports, so a binary built
+ * for baseline x86-64 still uses AVX2 where available. Other types, other
+ * architectures and old CPUs take the std:: algorithms.
+ *
+ * Floating point elements compare with ==, so NaN matches nothing and -0.0
+ * matches 0.0, as with the scalar loop. min and max are vectorized for
+ * integers of up to four bytes only; SSE and AVX2 lack 64 bit integer min, and
+ * NaN ordering would differ from std::min_element.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define DS_SIMD_X86 1
+#endif
+
+namespace ds {
+namespace simd {
+
+	/**
+	 * types whose equality is a lane compare: integers, float and double
+	 */
+	template <class T>
+	struct is_vectorizable : std::integral_constant<bool, std::is_arithmetic<T>::value
+		&& (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8)
+		&& (std::is_integral<T>::value || std::is_same<T, float>::value || std::is_same<T, double>::value)> {};
+
+	template <class T>
+	struct has_vector_minmax : std::integral_constant<bool, std::is_integral<T>::value && sizeof(T) <= 4> {};
+
+	enum class instruction_set { scalar, sse42, avx2 };
+
+	/**
+	 * the widest instruction set both compiled in and supported by the CPU
+	 */
+	inline instruction_set supported() {
+#ifdef DS_SIMD_X86
+		static const instruction_set level = __builtin_cpu_supports("avx2") ? instruction_set::avx2
+			: __builtin_cpu_supports("sse4.2") ? instruction_set::sse42 : instruction_set::scalar;
+		return level;
+#else
+		return instruction_set::scalar;
+#endif
+	}
+
+#ifdef DS_SIMD_X86
+	namespace detail {
+
+		/**
+		 * the bits of value as an integer of the same width, for set1
+		 */
+		template <class T>
+		inline auto lane_bits(T value) {
+			typedef typename std::conditional<sizeof(T) == 1, int8_t,
+				typename std::conditional<sizeof(T) == 2, int16_t,
+				typename std::conditional<sizeof(T) == 4, int32_t, int64_t>::type>::type>::type bits_type;
+			bits_type bits;
+			memcpy(&bits, &value, sizeof(T));
+			return bits;
+		}
+
+		// AVX2
+
+		template <class T>
+		__attribute__((target("avx2"))) inline __m256i broadcast256(T value) {
+			if constexpr (sizeof(T) == 1) return _mm256_set1_epi8(lane_bits(value));
+			else if constexpr (sizeof(T) == 2) return _mm256_set1_epi16(lane_bits(value));
+			else if constexpr (sizeof(T) == 4) return _mm256_set1_epi32(lane_bits(value));
+			else return _mm256_set1_epi64x(lane_bits(value));
+		}
+
+		/**
+		 * all ones in the lanes where a == b
+		 */
+		template <class T>
+		__attribute__((target("avx2"))) inline __m256i equal256(__m256i a, __m256i b) {
+			if constexpr (std::is_same<T, float>::value)
+				return _mm256_castps_si256(_mm256_cmp_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _CMP_EQ_OQ));
+			else if constexpr (std::is_same<T, double>::value)
+				return _mm256_castpd_si256(_mm256_cmp_pd(_mm256_castsi256_pd(a), _mm256_castsi256_pd(b), _CMP_EQ_OQ));
+			else if constexpr (sizeof(T) == 1) return _mm256_cmpeq_epi8(a, b);
+			else if constexpr (sizeof(T) == 2) return _mm256_cmpeq_epi16(a, b);
+			else if constexpr (sizeof(T) == 4) return _mm256_cmpeq_epi32(a, b);
+			else return _mm256_cmpeq_epi64(a, b);
+		}
+
+		template <class T>
+		__attribute__((target("avx2"))) inline __m256i min256(__m256i a, __m256i b) {
+			if constexpr (sizeof(T) == 1) return std::is_signed<T>::value ? _mm256_min_epi8(a, b) : _mm256_min_epu8(a, b);
+			else if constexpr (sizeof(T) == 2) return std::is_signed<T>::value ? _mm256_min_epi16(a, b) : _mm256_min_epu16(a, b);
+			else return std::is_signed<T>::value ? _mm256_min_epi32(a, b) : _mm256_min_epu32(a, b);
+		}
+
+		template <class T>
+		__attribute__((target("avx2"))) inline __m256i max256(__m256i a, __m256i b) {
+			if constexpr (sizeof(T) == 1) return std::is_signed<T>::value ? _mm256_max_epi8(a, b) : _mm256_max_epu8(a, b);
+			else if constexpr (sizeof(T) == 2) return std::is_signed<T>::value ? _mm256_max_epi16(a, b) : _mm256_max_epu16(a, b);
+			else return std::is_signed<T>::value ? _mm256_max_epi32(a, b) : _mm256_max_epu32(a, b);
+		}
+
+		__attribute__((target("avx2"))) inline __m256i load256(const void* p) { return _mm256_loadu_si256(static_cast<const __m256i*>(p)); }
+
+		/**
+		 * A byte mask has sizeof(T) bits per lane, so the first set bit over
+		 * sizeof(T) is the lane and the bit count over sizeof(T) is the number
+		 * of lanes.
+		 */
+		template <class T>
+		__attribute__((target("avx2"))) size_t find_avx2(const T* p, size_t n, T value) {
+			const __m256i needle = broadcast256(value);
+			const size_t step = 32 / sizeof(T);
+			size_t i = 0;
+			for (; i + step <= n; i += step) {
+				const unsigned mask = _mm256_movemask_epi8(equal256<T>(load256(p + i), needle));
+				if (mask) return i + __builtin_ctz(mask) / sizeof(T);
+			}
+			for (; i < n && !(p[i] == value); ++i) {}
+			return i;
+		}
+
+		template <class T>
+		__attribute__((target("avx2,popcnt"))) size_t count_avx2(const T* p, size_t n, T value) {
+			const __m256i needle = broadcast256(value);
+			const size_t step = 32 / sizeof(T);
+			size_t bits = 0, i = 0;
+			for (; i + step <= n; i += step)
+				bits += __builtin_popcount(_mm256_movemask_epi8(equal256<T>(load256(p + i), needle)));
+			size_t count = bits / sizeof(T);
+			for (; i < n; ++i)
+				count += p[i] == value;
+			return count;
+		}
+
+		template <class T>
+		__attribute__((target("avx2"))) size_t mismatch_avx2(const T* a, const T* b, size_t n) {
+			const size_t step = 32 / sizeof(T);
+			size_t i = 0;
+			for (; i + step <= n; i += step) {
+				const unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(equal256<T>(load256(a + i), load256(b + i))));
+				if (mask) return i + __builtin_ctz(mask) / sizeof(T);
+			}
+			for (; i < n && a[i] == b[i]; ++i) {}
+			return i;
+		}
+
+		/**
+		 * the smallest (or largest) value of p[0, n), n must not be zero
+		 */
+		template <bool is_max, class T>
+		__attribute__((target("avx2"))) T extreme_avx2(const T* p, size_t n) {
+			const size_t step = 32 / sizeof(T);
+			if (n < step) return is_max ? *std::max_element(p, p + n) : *std::min_element(p, p + n);
+			__m256i best = load256(p);
+			size_t i = step;
+			for (; i + step <= n; i += step)
+				best = is_max ? max256<T>(best, load256(p + i)) : min256<T>(best, load256(p + i));
+			T lanes[32 / sizeof(T)];
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), best);
+			T result = lanes[0];
+			for (size_t lane = 1; lane < step; ++lane)
+				result = is_max ? std::max(result, lanes[lane]) : std::min(result, lanes[lane]);
+			for (; i < n; ++i)
+				result = is_max ? std::max(result, p[i]) : std::min(result, p[i]);
+			return result;
+		}
+
+		// SSE4.2
+
+		template <class T>
+		__attribute__((target("sse4.2"))) inline __m128i broadcast128(T value) {
+			if constexpr (sizeof(T) == 1) return _mm_set1_epi8(lane_bits(value));
+			else if constexpr (sizeof(T) == 2) return _mm_set1_epi16(lane_bits(value));
+			else if constexpr (sizeof(T) == 4) return _mm_set1_epi32(lane_bits(value));
+			else return _mm_set1_epi64x(lane_bits(value));
+		}
+
+		template <class T>
+		__attribute__((target("sse4.2"))) inline __m128i equal128(__m128i a, __m128i b) {
+			if constexpr (std::is_same<T, float>::value)
+				return _mm_castps_si128(_mm_cmpeq_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b)));
+			else if constexpr (std::is_same<T, double>::value)
+				return _mm_castpd_si128(_mm_cmpeq_pd(_mm_castsi128_pd(a), _mm_castsi128_pd(b)));
+			else if constexpr (sizeof(T) == 1) return _mm_cmpeq_epi8(a, b);
+			else if constexpr (sizeof(T) == 2) return _mm_cmpeq_epi16(a, b);
+			else if constexpr (sizeof(T) == 4) return _mm_cmpeq_epi32(a, b);
+			else return _mm_cmpeq_epi64(a, b);
+		}
+
+		template <class T>
+		__attribute__((target("sse4.2"))) inline __m128i min128(__m128i a, __m128i b) {
+			if constexpr (sizeof(T) == 1) return std::is_signed<T>::value ? _mm_min_epi8(a, b) : _mm_min_epu8(a, b);
+			else if constexpr (sizeof(T) == 2) return std::is_signed<T>::value ? _mm_min_epi16(a, b) : _mm_min_epu16(a, b);
+			else return std::is_signed<T>::value ? _mm_min_epi32(a, b) : _mm_min_epu32(a, b);
+		}
+
+		template <class T>
+		__attribute__((target("sse4.2"))) inline __m128i max128(__m128i a, __m128i b) {
+			if constexpr (sizeof(T) == 1) return std::is_signed<T>::value ? _mm_max_epi8(a, b) : _mm_max_epu8(a, b);
+			else if constexpr (sizeof(T) == 2) return std::is_signed<T>::value ? _mm_max_epi16(a, b) : _mm_max_epu16(a, b);
+			else return std::is_signed<T>::value ? _mm_max_epi32(a, b) : _mm_max_epu32(a, b);
+		}
+
+		__attribute__((target("sse4.2"))) inline __m128i load128(const void* p) { return _mm_loadu_si128(static_cast<const __m128i*>(p)); }
+
+		template <class T>
+		__attribute__((target("sse4.2"))) size_t find_sse42(const T* p, size_t n, T value) {
+			const __m128i needle = broadcast128(value);
+			const size_t step = 16 / sizeof(T);
+			size_t i = 0;
+			for (; i + step <= n; i += step) {
+				const unsigned mask = _mm_movemask_epi8(equal128<T>(load128(p + i), needle));
+				if (mask) return i + __builtin_ctz(mask) / sizeof(T);
+			}
+			for (; i < n && !(p[i] == value); ++i) {}
+			return i;
+		}
+
+		template <class T>
+		__attribute__((target("sse4.2,popcnt"))) size_t count_sse42(const T* p, size_t n, T value) {
+			const __m128i needle = broadcast128(value);
+			const size_t step = 16 / sizeof(T);
+			size_t bits = 0, i = 0;
+			for (; i + step <= n; i += step)
+				bits += __builtin_popcount(_mm_movemask_epi8(equal128<T>(load128(p + i), needle)));
+			size_t count = bits / sizeof(T);
+			for (; i < n; ++i)
+				count += p[i] == value;
+			return count;
+		}
+
+		template <class T>
+		__attribute__((target("sse4.2"))) size_t mismatch_sse42(const T* a, const T* b, size_t n) {
+			const size_t step = 16 / sizeof(T);
+			size_t i = 0;
+			for (; i + step <= n; i += step) {
+				const unsigned mask = ~_mm_movemask_epi8(equal128<T>(load128(a + i), load128(b + i))) & 0xffff;
+				if (mask) return i + __builtin_ctz(mask) / sizeof(T);
+			}
+			for (; i < n && a[i] == b[i]; ++i) {}
+			return i;
+		}
+
+		template <bool is_max, class T>
+		__attribute__((target("sse4.2"))) T extreme_sse42(const T* p, size_t n) {
+			const size_t step = 16 / sizeof(T);
+			if (n < step) return is_max ? *std::max_element(p, p + n) : *std::min_element(p, p + n);
+			__m128i best = load128(p);
+			size_t i = step;
+			for (; i + step <= n; i += step)
+				best = is_max ? max128<T>(best, load128(p + i)) : min128<T>(best, load128(p + i));
+			T lanes[16 / sizeof(T)];
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), best);
+			T result = lanes[0];
+			for (size_t lane = 1; lane < step; ++lane)
+				result = is_max ? std::max(result, lanes[lane]) : std::min(result, lanes[lane]);
+			for (; i < n; ++i)
+				result = is_max ? std::max(result, p[i]) : std::min(result, p[i]);
+			return result;
+		}
+	}
+#endif
+
+	/**
+	 * the first element of [first, last) equal to value, or last
+	 */
+	template <class T>
+	const T* find(const T* first, const T* last, const T& value) {
+#ifdef DS_SIMD_X86
+		if constexpr (is_vectorizable<T>::value) {
+			switch (supported()) {
+			case instruction_set::avx2: return first + detail::find_avx2(first, last - first, value);
+			case instruction_set::sse42: return first + detail::find_sse42(first, last - first, value);
+			case instruction_set::scalar: break;
+			}
+		}
+#endif
+		return std::find(first, last, value);
+	}
+
+	/**
+	 * the number of elements of [first, last) equal to value
+	 */
+	template <class T>
+	size_t count(const T* first, const T* last, const T& value) {
+#ifdef DS_SIMD_X86
+		if constexpr (is_vectorizable<T>::value) {
+			switch (supported()) {
+			case instruction_set::avx2: return detail::count_avx2(first, last - first, value);
+			case instruction_set::sse42: return detail::count_sse42(first, last - first, value);
+			case instruction_set::scalar: break;
+			}
+		}
+#endif
+		return std::count(first, last, value);
+	}
+
+	/**
+	 * the index of the first position where a[0, n) and b[0, n) differ, or n
+	 */
+	template <class T>
+	size_t mismatch(const T* a, const T* b, size_t n) {
+#ifdef DS_SIMD_X86
+		if constexpr (is_vectorizable<T>::value) {
+			switch (supported()) {
+			case instruction_set::avx2: return detail::mismatch_avx2(a, b, n);
+			case instruction_set::sse42: return detail::mismatch_sse42(a, b, n);
+			case instruction_set::scalar: break;
+			}
+		}
+#endif
+		return std::mismatch(a, a + n, b).first - a;
+	}
+
+	template <class T>
+	bool equal(const T* a, const T* b, size_t n) { return mismatch(a, b, n) == n; }
+
+	/**
+	 * the first smallest element of [first, last), or last if it is empty
+	 */
+	template <class T>
+	const T* min_element(const T* first, const T* last) {
+#ifdef DS_SIMD_X86
+		if constexpr (has_vector_minmax<T>::value) {
+			if (first == last) return last;
+			switch (supported()) {
+			case instruction_set::avx2: return find(first, last, detail::extreme_avx2<false>(first, last - first));
+			case instruction_set::sse42: return find(first, last, detail::extreme_sse42<false>(first, last - first));
+			case instruction_set::scalar: break;
+			}
+		}
+#endif
+		return std::min_element(first, last);
+	}
+
+	/**
+	 * the first largest element of [first, last), or last if it is empty
+	 */
+	template <class T>
+	const T* max_element(const T* first, const T* last) {
+#ifdef DS_SIMD_X86
+		if constexpr (has_vector_minmax<T>::value) {
+			if (first == last) return last;
+			switch (supported()) {
+			case instruction_set::avx2: return find(first, last, detail::extreme_avx2<true>(first, last - first));
+			case instruction_set::sse42: return find(first, last, detail::extreme_sse42<true>(first, last - first));
+			case instruction_set::scalar: break;
+			}
+		}
+#endif
+		return std::max_element(first, last);
+	}
+}
+}
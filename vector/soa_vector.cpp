@@ -0,0 +1,320 @@
+/**
+ * Structure of arrays vector
+ *
+ * Stores each field of its elements in a separate Vector, so a loop over one
+ * field reads only that field's memory and can be vectorized. Element access
+ * returns tuples of references, and field<I>() gives the contiguous array of
+ * one field. All field arrays grow together by growth_factor, using the
+ * allocator rebound to each field type.
+ */
+#include "Vector.cpp"
+
+#include <stddef.h>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace ds {
+
+	/**
+	 * contiguous view of one field
+	 */
+	template <class T>
+	class field_span {
+	public:
+		typedef T element_type;
+		typedef size_t size_type;
+		typedef T* iterator;
+
+		field_span() : m_data(), m_size() {}
+
+		field_span(T* data, size_type size) : m_data(data), m_size(size) {}
+
+		T* data() const { return m_data; }
+
+		size_type size() const { return m_size; }
+
+		bool empty() const { return m_size == 0; }
+
+		T& operator[](size_type n) const { return m_data[n]; }
+
+		iterator begin() const { return m_data; }
+
+		iterator end() const { return m_data + m_size; }
+
+	private:
+		T* m_data;
+		size_type m_size;
+	};
+
+	template <class Allocator, size_t growth_factor, class... Fields>
+	class basic_soa_vector {
+
+		template <class Field>
+		using field_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Field>;
+
+		typedef std::tuple<Vector<Fields, growth_factor, field_allocator<Fields>>...> storage_type;
+		typedef std::index_sequence_for<Fields...> field_indices;
+
+	public:
+		typedef std::tuple<Fields...> value_type;
+		typedef std::tuple<Fields&...> reference;
+		typedef std::tuple<const Fields&...> const_reference;
+		typedef Allocator allocator_type;
+		typedef size_t size_type;
+		typedef ptrdiff_t difference_type;
+
+		template <size_t I>
+		using field_type = typename std::tuple_element<I, value_type>::type;
+
+		/**
+		 * Random access iterator over element indices. Dereferencing yields a
+		 * tuple of references rather than a real reference, so algorithms that
+		 * take the address of an element do not apply.
+		 */
+		template <bool is_const>
+		class basic_iterator {
+			typedef typename std::conditional<is_const, const basic_soa_vector*, basic_soa_vector*>::type vector_pointer;
+
+		public:
+			typedef std::random_access_iterator_tag iterator_category;
+			typedef std::tuple<Fields...> value_type;
+			typedef ptrdiff_t difference_type;
+			typedef typename std::conditional<is_const, std::tuple<const Fields&...>, std::tuple<Fields&...>>::type reference;
+			typedef void pointer;
+
+			basic_iterator() : m_vector(), m_index() {}
+
+			basic_iterator(vector_pointer vector, size_type index) : m_vector(vector), m_index(index) {}
+
+			template <bool other_const, class = typename std::enable_if<is_const && !other_const>::type>
+			basic_iterator(const basic_iterator<other_const>& other) : m_vector(other.m_vector), m_index(other.m_index) {}
+
+			reference operator*() const { return (*m_vector)[m_index]; }
+
+			reference operator[](difference_type n) const { return (*m_vector)[m_index + n]; }
+
+			basic_iterator& operator++() {
+				++m_index;
+				return *this;
+			}
+
+			basic_iterator operator++(int) { return basic_iterator(m_vector, m_index++); }
+
+			basic_iterator& operator--() {
+				--m_index;
+				return *this;
+			}
+
+			basic_iterator operator--(int) { return basic_iterator(m_vector, m_index--); }
+
+			basic_iterator& operator+=(difference_type n) {
+				m_index += n;
+				return *this;
+			}
+
+			basic_iterator& operator-=(difference_type n) {
+				m_index -= n;
+				return *this;
+			}
+
+			basic_iterator operator+(difference_type n) const { return basic_iterator(m_vector, m_index + n); }
+
+			basic_iterator operator-(difference_type n) const { return basic_iterator(m_vector, m_index - n); }
+
+			difference_type operator-(const basic_iterator& rhs) const { return m_index - rhs.m_index; }
+
+			bool operator==(const basic_iterator& rhs) const { return m_index == rhs.m_index; }
+
+			bool operator!=(const basic_iterator& rhs) const { return m_index != rhs.m_index; }
+
+			bool operator<(const basic_iterator& rhs) const { return m_index < rhs.m_index; }
+
+			bool operator>(const basic_iterator& rhs) const { return m_index > rhs.m_index; }
+
+			bool operator<=(const basic_iterator& rhs) const { return m_index <= rhs.m_index; }
+
+			bool operator>=(const basic_iterator& rhs) const { return m_index >= rhs.m_index; }
+
+		private:
+			friend class basic_soa_vector;
+
+			vector_pointer m_vector;
+			size_type m_index;
+		};
+
+		typedef basic_iterator<false> iterator;
+		typedef basic_iterator<true> const_iterator;
+
+		// Constructors
+
+		basic_soa_vector() = default;
+
+		explicit basic_soa_vector(const allocator_type& alloc) : m_fields(field_allocator<Fields>(alloc)...) {}
+
+		basic_soa_vector(std::initializer_list<value_type> il, const allocator_type& alloc = allocator_type())
+			: basic_soa_vector(alloc) {
+			reserve(il.size());
+			for (const value_type& val : il)
+				push_back(val);
+		}
+
+		// Iterators
+
+		iterator begin() { return iterator(this, 0); }
+
+		const_iterator begin() const { return const_iterator(this, 0); }
+
+		const_iterator cbegin() const { return begin(); }
+
+		iterator end() { return iterator(this, size()); }
+
+		const_iterator end() const { return const_iterator(this, size()); }
+
+		const_iterator cend() const { return end(); }
+
+		// Capacity
+
+		size_type size() const { return std::get<0>(m_fields).size(); }
+
+		bool empty() const { return size() == 0; }
+
+		size_type capacity() const { return std::get<0>(m_fields).capacity(); }
+
+		void reserve(size_type n) {
+			std::apply([n](auto&... fields) { (fields.reserve(n), ...); }, m_fields);
+		}
+
+		void shrink_to_fit() {
+			std::apply([](auto&... fields) { (fields.shrink_to_fit(), ...); }, m_fields);
+		}
+
+		void resize(size_type n) {
+			std::apply([n](auto&... fields) { (fields.resize(n), ...); }, m_fields);
+		}
+
+		// Element access
+
+		reference operator[](size_type n) { return element(n, field_indices()); }
+
+		const_reference operator[](size_type n) const { return element(n, field_indices()); }
+
+		reference at(size_type n) {
+			if (n >= size()) throw std::out_of_range("ds::soa_vector::at");
+			return (*this)[n];
+		}
+
+		const_reference at(size_type n) const {
+			if (n >= size()) throw std::out_of_range("ds::soa_vector::at");
+			return (*this)[n];
+		}
+
+		reference front() { return (*this)[0]; }
+
+		const_reference front() const { return (*this)[0]; }
+
+		reference back() { return (*this)[size() - 1]; }
+
+		const_reference back() const { return (*this)[size() - 1]; }
+
+		/**
+		 * the contiguous array holding field I of every element, invalidated
+		 * when the vector reallocates
+		 */
+		template <size_t I>
+		field_span<field_type<I>> field() { return field_span<field_type<I>>(data<I>(), size()); }
+
+		template <size_t I>
+		field_span<const field_type<I>> field() const { return field_span<const field_type<I>>(data<I>(), size()); }
+
+		template <size_t I>
+		field_type<I>* data() { return std::get<I>(m_fields).data(); }
+
+		template <size_t I>
+		const field_type<I>* data() const { return std::get<I>(m_fields).data(); }
+
+		// Modifiers
+
+		void push_back(const value_type& val) {
+			std::apply([this](const Fields&... values) { emplace_back(values...); }, val);
+		}
+
+		void push_back(value_type&& val) {
+			std::apply([this](Fields&... values) { emplace_back(std::move(values)...); }, val);
+		}
+
+		/**
+		 * @brief appends an element with one argument per field
+		 *
+		 * Every field array is grown before any field is constructed, so if a
+		 * constructor throws the fields already appended are removed again and
+		 * the vector is unchanged.
+		 */
+		template <class... Args>
+		void emplace_back(Args&&... args) {
+			static_assert(sizeof...(Args) == sizeof...(Fields), "ds::soa_vector::emplace_back: one argument per field");
+			if (size() == capacity()) reserve(empty() ? 1 : growth_factor*capacity());
+			emplace_fields<0>(std::forward<Args>(args)...);
+		}
+
+		void pop_back() {
+			std::apply([](auto&... fields) { (fields.pop_back(), ...); }, m_fields);
+		}
+
+		iterator erase(const_iterator position) {
+			const size_type n = position.m_index;
+			std::apply([n](auto&... fields) { (fields.erase(fields.begin() + n), ...); }, m_fields);
+			return iterator(this, n);
+		}
+
+		iterator erase(const_iterator first, const_iterator last) {
+			const size_type n = first.m_index, m = last.m_index;
+			std::apply([n, m](auto&... fields) { (fields.erase(fields.begin() + n, fields.begin() + m), ...); }, m_fields);
+			return iterator(this, n);
+		}
+
+		void clear() {
+			std::apply([](auto&... fields) { (fields.clear(), ...); }, m_fields);
+		}
+
+		void swap(basic_soa_vector& other) { std::swap(m_fields, other.m_fields); }
+
+	private:
+		storage_type m_fields;
+
+		template <size_t... I>
+		reference element(size_type n, std::index_sequence<I...>) { return reference(std::get<I>(m_fields)[n]...); }
+
+		template <size_t... I>
+		const_reference element(size_type n, std::index_sequence<I...>) const {
+			return const_reference(std::get<I>(m_fields)[n]...);
+		}
+
+		template <size_t I, class Arg, class... Args>
+		void emplace_fields(Arg&& arg, Args&&... args) {
+			std::get<I>(m_fields).emplace_back(std::forward<Arg>(arg));
+			if constexpr (sizeof...(Args) > 0) {
+				try {
+					emplace_fields<I + 1>(std::forward<Args>(args)...);
+				} catch (...) {
+					std::get<I>(m_fields).pop_back();
+					throw;
+				}
+			}
+		}
+	};
+
+	template <class... Fields>
+	using soa_vector = basic_soa_vector<std::allocator<char>, 2, Fields...>;
+}
+
+namespace std {
+	template <class Allocator, size_t growth_factor, class... Fields>
+	void swap(ds::basic_soa_vector<Allocator, growth_factor, Fields...>& lhs,
+	          ds::basic_soa_vector<Allocator, growth_factor, Fields...>& rhs) {
+		lhs.swap(rhs);
+	}
+}